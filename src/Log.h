@@ -2,12 +2,15 @@
 #define NOWTECH_LOG
 
 #include "LogMessageBase.h"
+#include "LogStatisticsVoid.h"
+#include "LogRateLimit.h"
 #include "PoolAllocator.h"
 #include <type_traits>
 #include <algorithm>
 #include <atomic>
 #include <limits>
 #include <array>
+#include <bit>
 
 namespace nowtech::log {
   
@@ -24,13 +27,11 @@ enum class TaskRepresentation : uint8_t {
   cName = 2u
 };
 
-using LogTopic = int8_t; // this needs to be signed to let the overload resolution work
-
-template<typename tQueue, typename tSender, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, typename tSender::tAppInterface_::LogTime tRefreshPeriod>
+template<typename tQueue, typename tSender, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, typename tSender::tAppInterface_::LogTime tRefreshPeriod, typename tStatistics = StatisticsVoid>
 class Log;
 
 class TopicInstance final {
-  template<typename tQueue, typename tSender, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, typename tSender::tAppInterface_::LogTime tRefreshPeriod>
+  template<typename tQueue, typename tSender, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, typename tSender::tAppInterface_::LogTime tRefreshPeriod, typename tStatistics>
   friend class Log;
 
 public:
@@ -101,6 +102,40 @@ public:
   LogFormat tickFormat      = D5;
   LogFormat defaultFormat   = Fm;
 
+  /// Minimum time between two summaries of the lines suppressed by the same
+  /// rate limit or sampling, or of the repetitions of a line, in LogTime
+  /// units (ms for std, ticks for FreeRTOS).
+  uint32_t suppressionReportPeriod = 1000u;
+
+  /// If true, the transmitter sends only the first of identical consecutive
+  /// lines of a task (apart from the tick), and counts the rest in the form
+  /// -=- Last line of task: 03 repeated 12345 times
+  /// Only in background mode.
+  bool deduplicate = false;
+
+  /// Maximum number of messages a task may hold in the shared pool of
+  /// partial groups, 0 for no limit. Groups reaching it are discarded, so a
+  /// task building huge groups can't starve the others. Should be more than
+  /// the messages in the longest group. Only in background mode, can be set
+  /// per task using Log::setTaskPoolQuota.
+  uint32_t taskPoolQuota = 0u;
+
+  /// In background mode groups longer than the transmit buffer of the sender
+  /// are sent in several parts. Beyond this length the rest of the group is
+  /// replaced by -=- Truncated
+  /// 0 means no limit. Independently, a group has at most 32765 items, or
+  /// 125 if NOWTECH_LOG_MESSAGE_SEQUENCE_BITS is 8, and the transmitter
+  /// holds the whole group in the pool until it is complete.
+  uint32_t maxGroupLength = 0u;
+
+  /// Groups not completed within this time (in LogTime units) after their
+  /// first message arrived are sent as they are, marked as
+  /// -=- Stale group of task: 03
+  /// and the rest of them arriving later is dropped. Such groups come from
+  /// tasks killed while logging or from lost terminal messages. 0 means
+  /// waiting forever. Only in background mode.
+  uint32_t staleGroupTimeout = 0u;
+
   LogConfig() noexcept = default;
 };
 
@@ -109,7 +144,7 @@ enum class LogShiftChainEndMarker : uint8_t {
   cEnd      = 0u
 };
 
-template<typename tQueue, typename tSender, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, typename tSender::tAppInterface_::LogTime tRefreshPeriod>
+template<typename tQueue, typename tSender, LogTopic tMaxTopicCount, TaskRepresentation tTaskRepresentation, size_t tDirectBufferSize, typename tSender::tAppInterface_::LogTime tRefreshPeriod, typename tStatistics>
 class Log final {
 private:
   static constexpr bool csShutdownLog      = tSender::csVoid;
@@ -118,6 +153,7 @@ private:
   using tAppInterface = typename tSender::tAppInterface_;
   using tConverter = typename tSender::tConverter_;
   using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator = typename tConverter::Iterator;
   using LogTime = typename tAppInterface::LogTime;
   using TopicName = char const *;
 
@@ -130,46 +166,127 @@ private:
   static constexpr TaskId   csMaxTotalTaskCount = tAppInterface::csMaxTaskCount + 1u;
   static constexpr size_t   csListItemOverhead  = sizeof(void*) * 8u;
   static constexpr bool     csConstantTaskNames = tAppInterface::csConstantTaskNames;
+  static constexpr bool     csAutoRegister      = tAppInterface::csAutoRegister;
+  static constexpr GroupSlot csGroupSlotCount   = tMessage::csGroupSlotCount;
+  static constexpr GroupSlot csInvalidGroupSlot = csGroupSlotCount;
+  static constexpr uint32_t  csAllGroupSlots    = (1u << csGroupSlotCount) - 1u;   // The generations of the slots are above these bits.
   
+  /// Senders routing by topic provide send(begin, end, topic).
+  static constexpr bool     csSenderTakesTopic  = requires(ConversionResult const *aPointer, LogTopic aTopic) { tSender::send(aPointer, aPointer, aTopic); };
   static constexpr LogTopic csFirstFreeTopic    = 0;
+  static constexpr LogTopic csInvalidTopic      = TopicInstance::csInvalidTopic;
   static constexpr MessageSequence csSequence0  = 0u;
   static constexpr MessageSequence csSequence1  = 1u;
+  static constexpr MessageSequence csLastSequence = tMessage::csGenerationFlag - 2u;  // Reserved for the truncation mark.
   static constexpr char csTerminalChar          = 0;
+  static constexpr size_t   csEmergencyBufferSize = 512u;
+  static constexpr uint32_t csEmergencyWaitCount  = 2u;     // Times tRefreshPeriod, for the transmitter to finish the group in hand.
+  static constexpr size_t   csDeduplicationBufferSize = 512u;  // Longer items are compared only up to this length.
+  static constexpr uint64_t csFnvOffsetBasis      = 14695981039346656037u;
+  static constexpr uint64_t csFnvPrime            = 1099511628211u;
 
   using Occupier = typename tAppInterface::Occupier;
   using Allocator = memory::PoolAllocator<tMessage, Occupier>;
   using MessageQueue = std::list<tMessage, Allocator>;
   using MessageQueueArray = std::array<MessageQueue*, csMaxTotalTaskCount>; // Need the indirection to be able use allocator in constructor call.
   // Could introduce a new list type but the performance gain would be less than a percent.
-  using TaskShutdownArray = std::array<std::atomic<bool>, csMaxTotalTaskCount>;
+  /// cRelease: the task exited without unregistering, so the transmitter
+  /// releases its ID after processing its last messages.
+  enum class TaskShutdown : uint8_t {
+    cNone    = 0u,
+    cDone    = 1u,
+    cRelease = 2u
+  };
+  using TaskShutdownArray = std::array<std::atomic<TaskShutdown>, csMaxTotalTaskCount>;
+  /// Last line of a task sent and its repetitions not reported yet.
+  struct Repetition final {
+    uint64_t mHash;
+    uint32_t mCount;
+    LogTime  mSince;      // First repetition not reported yet.
+    LogTopic mTopic;
+    bool     mValid;
+  };
+  using RepetitionArray = std::array<Repetition, csMaxTotalTaskCount>;
+  using TaskQuotaArray = std::array<std::atomic<uint32_t>, csMaxTotalTaskCount>;
+  using GroupSlotArray = std::array<std::atomic<uint32_t>, csMaxTotalTaskCount>;   // Bit set of the slots in use, and of their generations.
+  /// Direct mode buffers of a thread, one for each group it may build at the
+  /// same time. Zero initialized, so the thread-local instance needs no guard.
+  struct DirectBuffers final {
+    std::array<std::array<ConversionResult, tDirectBufferSize>, csGroupSlotCount> mBuffers;
+    uint32_t mUsedSlots;
+  };
+  /// Age of a partial group, used by the transmitter only.
+  struct GroupState final {
+    LogTime         mStart;         // Arrival of the first message in the list.
+    bool            mGeneration;    // Of the group flushed as stale.
+    bool            mStale;         // The group was flushed, its rest gets dropped.
+  };
+  using GroupStateArray = std::array<GroupState, csMaxTotalTaskCount>;
+  /// The arrays above hold the first group slot of each task. Most tasks
+  /// never build two groups at the same time, so the other slots of a task
+  /// get their table only when it first uses one of them.
+  struct GroupSlotTable final {
+    std::array<MessageQueue*, csGroupSlotCount - 1u> mMessageQueues;
+    std::array<GroupState, csGroupSlotCount - 1u>    mGroupStates;
+  };
+  using GroupSlotTableArray = std::array<GroupSlotTable*, csMaxTotalTaskCount>;
 
   static_assert(csPayloadSizeNet > 0u);
+  static_assert(csGroupSlotCount > 0u && 2u * csGroupSlotCount <= std::numeric_limits<uint32_t>::digits);
   static_assert(csInvalidTaskId == std::numeric_limits<TaskId>::max());
   static_assert(csIsrTaskId == std::numeric_limits<TaskId>::min());
   static_assert(csMaxTaskCount < std::numeric_limits<TaskId>::max());
   static_assert(std::is_same_v<tAppInterface, typename tQueue::tAppInterface_>);
   static_assert(std::is_same_v<tMessage, typename tConverter::tMessage_>);
+  static_assert(csSendInBackground || !tAppInterface::csLogFromIsr || tAppInterface::csLockFromIsr, "Direct mode locks in the logging context, use the queue to log from interrupts or signal handlers.");
+  static_assert(!csSendInBackground || tMessage::csStoresTopic || !(csSenderTakesTopic || tStatistics::csEnabled), "The topic is needed in the messages: use MessageCompact with tStoreTopic = true.");
 
   inline static constexpr char csRegisteredTask[]    = "-=- Registered task:";
   inline static constexpr char csUnregisteredTask[]  = "-=- Unregistered task:";
+  inline static constexpr char csTruncatedGroup[]    = "-=- Truncated group of task:";
+  inline static constexpr char csTruncated[]         = "-=- Truncated";
+  inline static constexpr char csSuppressed[]        = "-=- Suppressed";
+  inline static constexpr char csSuppressedLines[]   = "lines";
+  inline static constexpr char csRepeatedLine[]      = "-=- Last line of task:";
+  inline static constexpr char csRepeated[]          = "repeated";
+  inline static constexpr char csRepeatedTimes[]     = "times";
+  inline static constexpr char csStaleGroup[]        = "-=- Stale group of task:";
   
   inline static LogConfig const                       *sConfig;
   inline static std::atomic<LogTopic>                  sNextFreeTopic;
   inline static std::atomic<bool>                      sKeepAliveTask;
+  inline static std::atomic<bool>                      sEmergency;
+  inline static std::atomic<bool>                      sTransmitterParked;
   inline static std::array<TopicName, tMaxTopicCount>  sRegisteredTopics;
+  inline static std::array<nowtech::log::RateLimit<tAppInterface>, tMaxTopicCount> sTopicLimits;
+  inline static std::atomic<nowtech::log::RateLimit<tAppInterface>*> sListedLimits;   // Those ever suppressing, kept across init().
   inline static TaskShutdownArray                     *sTaskShutdowns;
+  inline static std::atomic<LogTopic>                  sStatisticsTopic;
+  inline static LogTime                                sStatisticsReportPeriod;
+  inline static LogTime                                sLastStatisticsReport;   // Transmitter only after registration.
+  inline static LogTime                                sLastFlush;              // Transmitter only.
 
   inline static Occupier           sOccupier;
   inline static Allocator         *sAllocator;
   inline static MessageQueueArray *sMessageQueues;
+  inline static RepetitionArray   *sRepetitions;      // Only if deduplicating.
+  inline static TaskQuotaArray    *sTaskPoolQuotas;
+  inline static GroupSlotArray    *sGroupSlots;
+  inline static GroupStateArray   *sGroupStates;      // Only if flushing stale groups.
+  inline static GroupSlotTableArray *sGroupSlotTables; // Transmitter only.
+  inline static LogTime            sLastStaleCheck;   // Transmitter only.
+  inline static thread_local DirectBuffers shDirectBuffers;   // Only in direct mode.
 
   Log() = delete;
 
   /// This will be used to send via queue. It stores the first message, and sends it only with the terminal marker.
   class LogShiftChainHelperBackgroundSend final {
     TaskId          mTaskId;
+    LogTopic        mTopic;
     LogFormat       mNextFormat;
     MessageSequence mNextSequence;
+    GroupSlot       mGroupSlot;
+    MessageSequence mGenerationFlag;
     tMessage        mFirstMessage;
 
   public:
@@ -177,10 +294,39 @@ private:
 
     LogShiftChainHelperBackgroundSend() noexcept = delete;
 
-    LogShiftChainHelperBackgroundSend(TaskId const aTaskId) noexcept
-     : mTaskId(aTaskId)
-     , mNextSequence(0u) {
+    LogShiftChainHelperBackgroundSend(TaskId const aTaskId, LogTopic const aTopic = csInvalidTopic) noexcept
+     : mTaskId(sEmergency.load(std::memory_order_relaxed) ? csInvalidTaskId : aTaskId)
+     , mTopic(aTopic)
+     , mNextSequence(0u)
+     , mGroupSlot(acquireGroupSlot(mTaskId, aTopic))
+     , mGenerationFlag(mGroupSlot == csInvalidGroupSlot ? 0u : getGenerationFlag(mTaskId, mGroupSlot)) {
        mNextFormat.invalidate();
+       if(mGroupSlot == csInvalidGroupSlot) {
+         mTaskId = csInvalidTaskId;
+       }
+       else { // nothing to do
+       }
+    }
+
+    /// Moving takes over the group, so only the last owner terminates it.
+    LogShiftChainHelperBackgroundSend(LogShiftChainHelperBackgroundSend &&aOther) noexcept
+     : mTaskId(aOther.mTaskId)
+     , mTopic(aOther.mTopic)
+     , mNextFormat(aOther.mNextFormat)
+     , mNextSequence(aOther.mNextSequence)
+     , mGroupSlot(aOther.mGroupSlot)
+     , mGenerationFlag(aOther.mGenerationFlag)
+     , mFirstMessage(aOther.mFirstMessage) {
+      aOther.mTaskId = csInvalidTaskId;
+    }
+
+    LogShiftChainHelperBackgroundSend(LogShiftChainHelperBackgroundSend const &) = delete;
+    LogShiftChainHelperBackgroundSend& operator=(LogShiftChainHelperBackgroundSend const &) = delete;
+
+    /// Terminates the group if the chain was abandoned without Log::end,
+    /// for example because of an exception or an early return.
+    ~LogShiftChainHelperBackgroundSend() noexcept {
+      *this << end;
     }
 
     /// Can be used in application code to eliminate further operator<< calls when the topic is disabled.
@@ -189,11 +335,11 @@ private:
     }
 
     template<typename tValue>
-    LogShiftChainHelperBackgroundSend& operator<<(tValue const aValue) noexcept {
-      if(mTaskId != csInvalidTaskId && mNextSequence < std::numeric_limits<MessageSequence>::max()) {
+    LogShiftChainHelperBackgroundSend& operator<<(tValue const aValue) & noexcept {
+      if(mTaskId != csInvalidTaskId && hasRoom()) {
         LogFormat format = obtainFormat();
         tMessage message;
-        message.set(aValue, format, mTaskId, mNextSequence);
+        message.set(aValue, format, mTaskId, mNextSequence | mGenerationFlag, mTopic, mGroupSlot);
         sendOrStore(message);
       }
       else { // silently discard value, nothing to do
@@ -201,36 +347,55 @@ private:
       return *this;
     }
 
-    LogShiftChainHelperBackgroundSend& operator<<(char * const aValue) noexcept {
+    LogShiftChainHelperBackgroundSend& operator<<(char * const aValue) & noexcept {
       return sendCharPointer(aValue);
     }
 
-    LogShiftChainHelperBackgroundSend& operator<<(char const * const aValue) noexcept {
+    LogShiftChainHelperBackgroundSend& operator<<(char const * const aValue) & noexcept {
       return sendCharPointer(aValue);
     }
 
-    LogShiftChainHelperBackgroundSend& operator<<(LogFormat const aFormat) noexcept {
+    LogShiftChainHelperBackgroundSend& operator<<(LogFormat const aFormat) & noexcept {
       mNextFormat = aFormat;
       return *this;
     }
 
-    void operator<<(LogShiftChainEndMarker const) noexcept {
+    /// Chaining on a temporary keeps it an rvalue, so
+    /// auto logger = Log::i() << something; moves the group into logger.
+    template<typename tValue>
+    LogShiftChainHelperBackgroundSend&& operator<<(tValue const &aValue) && noexcept {
+      return std::move(static_cast<LogShiftChainHelperBackgroundSend&>(*this) << aValue);
+    }
+
+    void operator<<(LogShiftChainEndMarker const aEnd) && noexcept {
+      static_cast<LogShiftChainHelperBackgroundSend&>(*this) << aEnd;
+    }
+
+    /// Further items and ends are ignored.
+    void operator<<(LogShiftChainEndMarker const) & noexcept {
       if(mTaskId != csInvalidTaskId) {
-        tQueue::push(mFirstMessage);
+        if(mNextSequence > csSequence0) {
+          tStatistics::groupStarting(mTaskId);
+          tStatistics::groupPushed(mTaskId, push(mFirstMessage));
+        }
+        else { // nothing to do
+        }
+        releaseGroupSlot(mTaskId, mGroupSlot);
       }
       else { // nothing to do
       }
+      mTaskId = csInvalidTaskId;
     }
 
   private:
     LogShiftChainHelperBackgroundSend& sendCharPointer(char const * const aValue) noexcept {
-      if(mTaskId != csInvalidTaskId && mNextSequence < std::numeric_limits<MessageSequence>::max()) {
+      if(mTaskId != csInvalidTaskId && hasRoom()) {
         LogFormat format = obtainFormat();
         tMessage message;
         if(format.isStoredString()) {
           std::array<char, csPayloadSizeBr> payload;
           char const * where = aValue;
-          while(*where != csTerminalChar) {
+          while(*where != csTerminalChar && hasRoom()) {
             size_t copied = 0u;
             while(*where != csTerminalChar && copied < csPayloadSizeNet) {
               payload[copied] = *where;
@@ -243,12 +408,12 @@ private:
             }
             else { // nothing to do
             }
-            message.set(payload, format, mTaskId, mNextSequence);
+            message.set(payload, format, mTaskId, mNextSequence | mGenerationFlag, mTopic, mGroupSlot);
             sendOrStore(message);
           }
         }
         else {
-          message.set(aValue, format, mTaskId, mNextSequence);
+          message.set(aValue, format, mTaskId, mNextSequence | mGenerationFlag, mTopic, mGroupSlot);
           sendOrStore(message);
         }
       }
@@ -257,6 +422,22 @@ private:
       return *this;
     }
 
+    /// The last sequence number marks that the rest of the group was left out.
+    bool hasRoom() noexcept {
+      bool result = false;
+      if(mNextSequence < csLastSequence) {
+        result = true;
+      }
+      else if(mNextSequence == csLastSequence) {
+        tMessage message;
+        message.set(csTruncated, sConfig->defaultFormat, mTaskId, mNextSequence | mGenerationFlag, mTopic, mGroupSlot);
+        sendOrStore(message);
+      }
+      else { // silently discard value, nothing to do
+      }
+      return result;
+    }
+
     LogFormat obtainFormat() noexcept {
       LogFormat result;
       if(mNextFormat.isValid()) {
@@ -274,23 +455,72 @@ private:
         mFirstMessage = aMessage;
       }
       else {
-        tQueue::push(aMessage);
+        push(aMessage);
       }
       ++mNextSequence;
     }
+
+    /// Interrupt contexts must not take the locks the normal path may use.
+    bool push(tMessage const & aMessage) noexcept {
+      bool result;
+      if(mTaskId == csIsrTaskId) {
+        result = tQueue::pushFromIsr(aMessage);
+      }
+      else {
+        result = tQueue::push(aMessage);
+      }
+      tStatistics::pushed(mTaskId, result);
+      if(!result) {
+        tStatistics::dropped(mTaskId, mTopic, 1u);
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
   }; // class LogShiftChainHelperBackgroundSend
 
-  /// This will be used to send directly, blocking the current thread.
+  /// This will be used to send directly, blocking the current thread. The
+  /// group is collected in a buffer of the thread, so the helper must not be
+  /// moved to an other thread.
   class LogShiftChainHelperDirectSend final {
     TaskId          mTaskId;
+    LogTopic        mTopic;
     LogFormat       mNextFormat;
+    GroupSlot       mSlot;       // Of the buffer in shDirectBuffers.
+    size_t          mLength;
 
   public:
     LogShiftChainHelperDirectSend() noexcept = delete;
 
-    LogShiftChainHelperDirectSend(TaskId const aTaskId) noexcept
-     : mTaskId(aTaskId) {
+    LogShiftChainHelperDirectSend(TaskId const aTaskId, LogTopic const aTopic = csInvalidTopic) noexcept
+     : mTaskId(aTaskId)
+     , mTopic(aTopic)
+     , mSlot(acquireDirectBuffer(aTaskId, aTopic))
+     , mLength(0u) {
        mNextFormat.invalidate();
+       if(mSlot == csInvalidGroupSlot) {
+         mTaskId = csInvalidTaskId;
+       }
+       else { // nothing to do
+       }
+    }
+
+    /// Moving takes over the group, so only the last owner terminates it.
+    LogShiftChainHelperDirectSend(LogShiftChainHelperDirectSend &&aOther) noexcept
+     : mTaskId(aOther.mTaskId)
+     , mTopic(aOther.mTopic)
+     , mNextFormat(aOther.mNextFormat)
+     , mSlot(aOther.mSlot)
+     , mLength(aOther.mLength) {
+      aOther.mTaskId = csInvalidTaskId;
+    }
+
+    LogShiftChainHelperDirectSend(LogShiftChainHelperDirectSend const &) = delete;
+    LogShiftChainHelperDirectSend& operator=(LogShiftChainHelperDirectSend const &) = delete;
+
+    /// Sends what was collected if the chain was abandoned without Log::end.
+    ~LogShiftChainHelperDirectSend() noexcept {
+      *this << end;
     }
 
     /// Can be used in application code to eliminate further operator<< calls when the topic is disabled.
@@ -298,8 +528,10 @@ private:
       return mTaskId != csInvalidTaskId;
     }
 
+    /// Collects the group in the buffer. When it gets full, its content is
+    /// sent and the item is converted again in the empty buffer.
     template<typename tValue>
-    LogShiftChainHelperDirectSend& operator<<(tValue const aValue) {
+    LogShiftChainHelperDirectSend& operator<<(tValue const aValue) & {
       if(mTaskId != csInvalidTaskId) {
         LogFormat format;
         if(mNextFormat.isValid()) {
@@ -309,43 +541,126 @@ private:
         else {
           format = sConfig->defaultFormat;
         }
-        ConversionResult buffer[tDirectBufferSize];
-        tConverter converter(buffer, buffer + tDirectBufferSize);
-        converter.convert(aValue, format.mBase, format.mFill);
-        tAppInterface::lock();
-        tSender::send(buffer, converter.end());
-        tAppInterface::unlock();
+        append([aValue, format](tConverter &aConverter){ aConverter.convert(aValue, format.mBase, format.mFill); });
       }
       else { // silently discard value, nothing to do
       }
       return *this;
     }
 
-    LogShiftChainHelperDirectSend& operator<<(LogFormat const aFormat) noexcept {
+    LogShiftChainHelperDirectSend& operator<<(LogFormat const aFormat) & noexcept {
       mNextFormat = aFormat;
       return *this;
     }
 
-    void operator<<(LogShiftChainEndMarker const) noexcept {
+    /// Chaining on a temporary keeps it an rvalue, so
+    /// auto logger = Log::i() << something; moves the group into logger.
+    template<typename tValue>
+    LogShiftChainHelperDirectSend&& operator<<(tValue const &aValue) && {
+      return std::move(static_cast<LogShiftChainHelperDirectSend&>(*this) << aValue);
+    }
+
+    void operator<<(LogShiftChainEndMarker const aEnd) && noexcept {
+      static_cast<LogShiftChainHelperDirectSend&>(*this) << aEnd;
+    }
+
+    /// Sends the whole group at once, so lines of different tasks do not mix.
+    /// Further items and ends are ignored.
+    void operator<<(LogShiftChainEndMarker const) & noexcept {
       if(mTaskId != csInvalidTaskId) {
-        ConversionResult buffer[tDirectBufferSize];
-        tConverter converter(buffer, buffer + tDirectBufferSize);
-        converter.terminateSequence();
-        tAppInterface::lock();
-        tSender::send(buffer, converter.end());
-        tAppInterface::unlock();
+        append([](tConverter &aConverter){ aConverter.terminateSequence(); });
+        sendBuffer();
+        shDirectBuffers.mUsedSlots &= ~(1u << mSlot);
       }
       else { // nothing to do
       }
+      mTaskId = csInvalidTaskId;
+    }
+
+  private:
+    template<typename tConversion>
+    void append(tConversion const aConversion) {
+      ConversionResult * const buffer = shDirectBuffers.mBuffers[mSlot].data();
+      ConversionResult * const bufferEnd = buffer + tDirectBufferSize;
+      tConverter converter(buffer + mLength, bufferEnd);
+      aConversion(converter);
+      if(converter.end() == bufferEnd && mLength > 0u) {   // The item may have been truncated.
+        sendBuffer();
+        tConverter again(buffer, bufferEnd);
+        aConversion(again);
+        mLength = again.end() - buffer;
+      }
+      else {
+        mLength = converter.end() - buffer;
+      }
+    }
+
+    void sendBuffer() {
+      ConversionResult * const buffer = shDirectBuffers.mBuffers[mSlot].data();
+      tAppInterface::lock();
+      send(buffer, buffer + mLength, mTopic);
+      tAppInterface::unlock();
+      mLength = 0u;
     }
   }; // class LogShiftChainHelperDirectSend
 
+  /// Converts a group in the transmitter into the sender buffer. When an item
+  /// fills the buffer, the part before it is sent and the item is converted
+  /// again in a new buffer, so long groups go out in several parts, like in
+  /// direct mode.
+  class StreamingConversion final {
+    Iterator       mBegin;
+    Iterator       mEnd;
+    Iterator       mPosition;
+    size_t         mSentLength;
+    LogTopic const mTopic;
+
+  public:
+    StreamingConversion(LogTopic const aTopic) noexcept
+     : mSentLength(0u)
+     , mTopic(aTopic) {
+      auto [begin, end] = tSender::getBuffer();
+      mBegin = begin;
+      mEnd = end;
+      mPosition = begin;
+    }
+
+    size_t getLength() const noexcept {
+      return mSentLength + (mPosition - mBegin);
+    }
+
+    template<typename tConversion>
+    void append(tConversion const aConversion) noexcept {
+      tConverter converter(mPosition, mEnd);
+      aConversion(converter);
+      if(converter.end() == mEnd && mPosition > mBegin) {   // The item may have been truncated.
+        send(mBegin, mPosition, mTopic);
+        mSentLength += mPosition - mBegin;
+        auto [begin, end] = tSender::getBuffer();
+        mBegin = begin;
+        mEnd = end;
+        tConverter again(mBegin, mEnd);
+        aConversion(again);
+        mPosition = again.end();
+      }
+      else {
+        mPosition = converter.end();
+      }
+    }
+
+    /// Sends the last part.
+    void finish() noexcept {
+      append([](tConverter &aConverter){ aConverter.terminateSequence(); });
+      send(mBegin, mPosition, mTopic);
+    }
+  }; // class StreamingConversion
+
   /// This shuts down all logging code generation without uncommenting anything from user code, when compiled with aT least -O1 
   class LogShiftChainHelperEmpty final {
   public:
     LogShiftChainHelperEmpty() noexcept = delete;
 
-    LogShiftChainHelperEmpty(TaskId const) noexcept {
+    LogShiftChainHelperEmpty(TaskId const, LogTopic const = csInvalidTopic) noexcept {
     }
 
     /// Can be used in application code to eliminate further operator<< calls when the topic is disabled.
@@ -369,6 +684,9 @@ private:
   using LogShiftChainHelper = std::conditional_t<csShutdownLog, LogShiftChainHelperEmpty, std::conditional_t<csSendInBackground, LogShiftChainHelperBackgroundSend, LogShiftChainHelperDirectSend>>;
 
 public:
+  /// Call sites may have their own limit as a static local object, see i(RateLimit&).
+  using RateLimit = nowtech::log::RateLimit<tAppInterface>;
+
   /// Will be used as Log << something << to << log << Log::end;
   static constexpr LogShiftChainEndMarker end = LogShiftChainEndMarker::cEnd;
 
@@ -384,17 +702,49 @@ public:
         sAllocator = tAppInterface::template _new<Allocator>(csQueueSize, nodeSize, sOccupier);
         sMessageQueues = tAppInterface::template _new<MessageQueueArray>();
         sTaskShutdowns = tAppInterface::template _new<TaskShutdownArray>();
-        auto &messageQueues = *sMessageQueues;
-        for (size_t i = 0; i < csMaxTotalTaskCount; ++i) {
-          messageQueues[i] = tAppInterface::template _new<MessageQueue>(*sAllocator);
+        sTaskPoolQuotas = tAppInterface::template _new<TaskQuotaArray>();
+        for(auto &quota : *sTaskPoolQuotas) {
+          quota = aConfig.taskPoolQuota;
+        }
+        sGroupSlots = tAppInterface::template _new<GroupSlotArray>();
+        for(auto &slots : *sGroupSlots) {
+          slots = 0u;
+        }
+        sMessageQueues->fill(nullptr);    // Created on the first message of the group slot.
+        sGroupSlotTables = tAppInterface::template _new<GroupSlotTableArray>();
+        sGroupSlotTables->fill(nullptr);
+        if(aConfig.deduplicate) {
+          sRepetitions = tAppInterface::template _new<RepetitionArray>();
+          sRepetitions->fill(Repetition{});
         }
+        else {
+          sRepetitions = nullptr;
+        }
+        if(aConfig.staleGroupTimeout > 0u) {
+          sGroupStates = tAppInterface::template _new<GroupStateArray>();
+          sGroupStates->fill(GroupState{0u, false, false});
+          sLastStaleCheck = tAppInterface::getLogTime();
+        }
+        else {
+          sGroupStates = nullptr;
+        }
+        sLastFlush = tAppInterface::getLogTime();
         sKeepAliveTask = true;
+        sEmergency = false;
+        sTransmitterParked = false;
         tAppInterface::init(transmitterTaskFunction, std::forward<tTypes>(aArgs)...);
       } else {
         tAppInterface::init();
       }
       tQueue::init();
+      if constexpr(csAutoRegister) {
+        tAppInterface::setTaskRegisterHook(autoRegisterCurrentTask);
+        tAppInterface::setTaskExitHook(taskExited);
+      }
+      else { // nothing to do
+      }
       sNextFreeTopic = csFirstFreeTopic;
+      sStatisticsTopic = csInvalidTopic;
       std::fill_n(sRegisteredTopics.begin(), tMaxTopicCount, nullptr);
     }
     else { // nothing to do
@@ -404,15 +754,38 @@ public:
   // TODO note in docs about init and done sequence
   static void done() {
     if constexpr(!csShutdownLog) {
+      if constexpr(csAutoRegister) {
+        tAppInterface::setTaskRegisterHook(nullptr);
+        tAppInterface::setTaskExitHook(nullptr);    // Threads must not exit meanwhile.
+      }
+      else { // nothing to do
+      }
       if constexpr(csSendInBackground) {
         sKeepAliveTask = false;
         tAppInterface::waitForFinished();
-        auto &messageQueues = *sMessageQueues;
-        for(size_t i = 0; i < csMaxTotalTaskCount; ++i) {
-          tAppInterface::template _delete<MessageQueue>(messageQueues[i]);
+        forEachMessageQueue([](TaskId const, GroupSlot const, MessageQueue &aList){ tAppInterface::template _delete<MessageQueue>(&aList); });
+        for(auto table : *sGroupSlotTables) {
+          if(table != nullptr) {
+            tAppInterface::template _delete<GroupSlotTable>(table);
+          }
+          else { // nothing to do
+          }
         }
+        tAppInterface::template _delete<GroupSlotTableArray>(sGroupSlotTables);
         tAppInterface::template _delete<MessageQueueArray>(sMessageQueues);
         tAppInterface::template _delete<TaskShutdownArray>(sTaskShutdowns);
+        tAppInterface::template _delete<TaskQuotaArray>(sTaskPoolQuotas);
+        tAppInterface::template _delete<GroupSlotArray>(sGroupSlots);
+        if(sRepetitions != nullptr) {
+          tAppInterface::template _delete<RepetitionArray>(sRepetitions);
+        }
+        else { // nothing to do
+        }
+        if(sGroupStates != nullptr) {
+          tAppInterface::template _delete<GroupStateArray>(sGroupStates);
+        }
+        else { // nothing to do
+        }
         tAppInterface::template _delete<Allocator>(sAllocator);
       }
       else { // nothing to do
@@ -426,8 +799,8 @@ public:
   }
 
   /// Registers the current task if not already present. It can register
-  /// at most 254 tasks. All others will be handled as one.
-  /// NOTE: this method locks to inhibit concurrent access of methods with the same name.
+  /// at most 254 or 65534 tasks depending on NOWTECH_LOG_TASK_ID_BITS. All others will be handled as one.
+  /// NOTE: AppInterfaceStd claims the ID from a lock-free bitmap, other app interfaces may lock.
   static void registerCurrentTask() noexcept {
     if constexpr(!csShutdownLog) {
       registerCurrentTask(nullptr);
@@ -436,27 +809,22 @@ public:
     }
   }
 
-/// Registers the current task if not already present. It can register
-  /// at most 254 tasks. All others will be handled as one.
+  /// Registers the current task if not already present. It can register
+  /// at most 254 or 65534 tasks depending on NOWTECH_LOG_TASK_ID_BITS. All others will be handled as one.
+  /// A task registered already keeps its ID and its open groups, and may only get the new name.
   /// @param aTaskName Task name to use, when the osInterface supports it.
   static void registerCurrentTask(char const * const aTaskName) {
     if constexpr(!csShutdownLog) {
+      bool const registered = tAppInterface::isCurrentTaskRegistered();
       TaskId taskId = tAppInterface::registerCurrentTask(aTaskName);
-      if(taskId != csInvalidTaskId) {
-        if constexpr(csSendInBackground) {
-          (*sTaskShutdowns)[taskId] = false;
-        }
-        else { // nothing to do
-        }
-        if(sConfig->allowRegistrationLog) {
-          n(taskId) << csRegisteredTask << aTaskName << taskId << end;
-        }
-        else { // nothing to do
-        }
-      }
-      else {
+      if(taskId == csInvalidTaskId) {
         tAppInterface::fatalError(Exception::cOutOfTaskIdsOrDoubleRegistration);
       }
+      else if(!registered) {
+        taskRegistered(taskId, aTaskName);
+      }
+      else { // Resetting would clobber its open groups.
+      }
     }
     else { // nothing to do
     }
@@ -474,10 +842,12 @@ public:
       if constexpr(csSendInBackground) {
         tMessage message;
         message.setShutdown(taskId);
-        tQueue::push(message);
-        while(!(*sTaskShutdowns)[taskId]) {
-          tAppInterface::sleepWhileWaitingForTaskShutdown();
+        pushShutdown(message);
+        auto &state = (*sTaskShutdowns)[taskId];
+        for(TaskShutdown current = state; current != TaskShutdown::cDone; current = state) {
+          tAppInterface::waitForTaskShutdown(state, current);
         }
+        (*sTaskShutdowns)[taskId] = TaskShutdown::cNone;
       }
       else { // nothing to do
       }
@@ -487,6 +857,62 @@ public:
     }
   }
 
+  /// Last resort for fatal signal handlers, see AppInterfaceStd::installFatalSignalHandlers.
+  /// Stops accepting new groups, wakes the transmitter with a shutdown
+  /// message of csInvalidTaskId and waits at most csEmergencyWaitCount
+  /// refresh periods for it to park. Then drains the queue without blocking
+  /// or heap allocation, the list nodes come from the preallocated pool. If
+  /// the transmitter does not park, like when it is the crashing one,
+  /// nothing is drained, as its lists may be inconsistent. Messages of
+  /// groups without a list are dropped, as creating one would use the heap.
+  /// Complete groups and the partial ones marked as truncated are written
+  /// using tAppInterface::emergencyWrite instead of the possibly buffering
+  /// or locking sender. Logging is not possible afterwards.
+  static void emergencyDrain() noexcept {
+    if constexpr(!csShutdownLog && csSendInBackground) {
+      if(!sEmergency.exchange(true)) {
+        LogTime const start = tAppInterface::getLogTime();
+        tMessage wakeUp;
+        wakeUp.setShutdown(csInvalidTaskId);
+        tQueue::push(wakeUp);     // If it does not fit, the transmitter is not idle anyway.
+        while(!sTransmitterParked && static_cast<LogTime>(tAppInterface::getLogTime() - start) < csEmergencyWaitCount * tRefreshPeriod) { // The crashing one may be the transmitter itself.
+          tAppInterface::sleepWhileWaitingForTaskShutdown();
+        }
+        if(sTransmitterParked) { // Otherwise the lists may be in the middle of an update.
+          tMessage message;
+          while(tQueue::tryPop(message)) {
+            if(!message.isShutdown()) {
+              auto list = findMessageQueue(message.getTaskId(), message.getGroupSlot());
+              if(list == nullptr) { // Creating it would use the heap.
+                tStatistics::dropped(message.getTaskId(), message.getTopic(), 1u);
+              }
+              else if(insert(*list, message)) {
+                emergencyTransmit(*list, csInvalidTaskId);
+              }
+              else { // nothing to do
+              }
+            }
+            else { // nothing to do
+            }
+          }
+          forEachMessageQueue([](TaskId const aTaskId, GroupSlot const, MessageQueue &aList){
+            if(!aList.empty()) {
+              emergencyTransmit(aList, aTaskId);
+            }
+            else { // nothing to do
+            }
+          });
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
   static void registerTopic(TopicInstance &aTopic, char const * const aPrefix) {
     if constexpr(!csShutdownLog) {
       aTopic = sNextFreeTopic++;
@@ -494,6 +920,7 @@ public:
         tAppInterface::fatalError(Exception::cOutOfTopics);
       }
       else {
+        sTopicLimits[aTopic].clear();
         sRegisteredTopics[aTopic] = aPrefix;
       }
     }
@@ -501,6 +928,50 @@ public:
     }
   }
 
+  /// Lets through at most aCount lines of the topic in each aPeriod (in
+  /// LogTime units), in bursts of at most aCount. aCount == 0 removes the
+  /// limit. May be called any time after registering the topic.
+  static void setTopicRateLimit(LogTopic const aTopic, uint32_t const aCount, LogTime const aPeriod) noexcept {
+    if constexpr(!csShutdownLog) {
+      sTopicLimits[aTopic].setRate(aCount, aPeriod);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Lets through only every aInterval-th line of the topic, aInterval <= 1 removes sampling.
+  static void setTopicSampling(LogTopic const aTopic, uint32_t const aInterval) noexcept {
+    if constexpr(!csShutdownLog) {
+      sTopicLimits[aTopic].setSampling(aInterval);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Registers a topic like registerTopic, and makes the transmitter send the
+  /// report of tStatistics in it every aReportPeriod. Only in background mode,
+  /// and only with statistics enabled, otherwise it is a plain topic.
+  static void registerStatisticsTopic(TopicInstance &aTopic, char const * const aPrefix, LogTime const aReportPeriod) {
+    registerTopic(aTopic, aPrefix);
+    if constexpr(!csShutdownLog && csSendInBackground && tStatistics::csEnabled) {
+      sStatisticsReportPeriod = aReportPeriod;
+      sLastStatisticsReport = tAppInterface::getLogTime();
+      sStatisticsTopic.store(aTopic, std::memory_order_release);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Overrides LogConfig::taskPoolQuota for the given task, 0 for no limit.
+  /// The quota belongs to the ID, so it stays after the task unregisters.
+  static void setTaskPoolQuota(TaskId const aTaskId, uint32_t const aQuota) noexcept {
+    if constexpr(!csShutdownLog && csSendInBackground) {
+      (*sTaskPoolQuotas)[aTaskId].store(aQuota, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+  }
+
   static TaskId getCurrentTaskId() noexcept {
     if constexpr(!csShutdownLog) {
       return tAppInterface::getCurrentTaskId();
@@ -510,6 +981,18 @@ public:
     }
   }
 
+  /// Snapshot of the counters of tStatistics, an empty struct with StatisticsVoid.
+  /// Senders counting their losses contribute it as well.
+  static auto getStatistics() noexcept {
+    auto result = tStatistics::getSnapshot();
+    if constexpr(requires { result.senderDroppedCount = tSender::getDroppedCount(); }) {
+      result.senderDroppedCount = tSender::getDroppedCount();
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
   static LogShiftChainHelper i() noexcept {
     if constexpr(!csShutdownLog) {
       TaskId const taskId = tAppInterface::getCurrentTaskId();
@@ -533,7 +1016,7 @@ public:
     if constexpr(!csShutdownLog) {
       if(sRegisteredTopics[aTopic] != nullptr) {
         TaskId const taskId = tAppInterface::getCurrentTaskId();
-        return sendHeader(taskId, sRegisteredTopics[aTopic]);
+        return admit(sTopicLimits[aTopic], taskId, aTopic) ? sendHeader(taskId, aTopic, sRegisteredTopics[aTopic]) : LogShiftChainHelper{csInvalidTaskId};
       }
       else {
         return sendHeader(csInvalidTaskId);
@@ -545,9 +1028,38 @@ public:
   }
 
   static LogShiftChainHelper i(LogTopic const aTopic, TaskId const aTaskId) noexcept {
+    if constexpr(!csShutdownLog) {
+      if(sRegisteredTopics[aTopic] != nullptr && admit(sTopicLimits[aTopic], aTaskId, aTopic)) {
+        return sendHeader(aTaskId, aTopic, sRegisteredTopics[aTopic]);
+      }
+      else {
+        return sendHeader(csInvalidTaskId);
+      }
+    }
+    else {
+      return LogShiftChainHelper{csInvalidTaskId};
+    }
+  }
+
+  /// Logs only if the limit of the call site lets the line through, like
+  /// static Log::RateLimit limit{10u, 1000u};
+  /// Log::i(limit) << "hot loop failed" << Log::end;
+  static LogShiftChainHelper i(RateLimit &aLimit) noexcept {
+    if constexpr(!csShutdownLog) {
+      TaskId const taskId = tAppInterface::getCurrentTaskId();
+      return admit(aLimit, taskId, csInvalidTopic) ? sendHeader(taskId) : LogShiftChainHelper{csInvalidTaskId};
+    }
+    else {
+      return LogShiftChainHelper{csInvalidTaskId};
+    }
+  }
+
+  /// Both the topic limit and the call site limit apply.
+  static LogShiftChainHelper i(LogTopic const aTopic, RateLimit &aLimit) noexcept {
     if constexpr(!csShutdownLog) {
       if(sRegisteredTopics[aTopic] != nullptr) {
-        return sendHeader(aTaskId, sRegisteredTopics[aTopic]);
+        TaskId const taskId = tAppInterface::getCurrentTaskId();
+        return admit(sTopicLimits[aTopic], taskId, aTopic) && admit(aLimit, taskId, aTopic) ? sendHeader(taskId, aTopic, sRegisteredTopics[aTopic]) : LogShiftChainHelper{csInvalidTaskId};
       }
       else {
         return sendHeader(csInvalidTaskId);
@@ -579,7 +1091,8 @@ public:
   static LogShiftChainHelper n(LogTopic const aTopic) noexcept {
     if constexpr(!csShutdownLog) {
       if(sRegisteredTopics[aTopic] != nullptr) {
-        return LogShiftChainHelper{tAppInterface::getCurrentTaskId()};
+        TaskId const taskId = tAppInterface::getCurrentTaskId();
+        return LogShiftChainHelper{admit(sTopicLimits[aTopic], taskId, aTopic) ? taskId : csInvalidTaskId, aTopic};
       }
       else {
         return LogShiftChainHelper{csInvalidTaskId};
@@ -591,9 +1104,34 @@ public:
   }
 
   static LogShiftChainHelper n(LogTopic const aTopic, TaskId const aTaskId) noexcept {
+    if constexpr(!csShutdownLog) {
+      if(sRegisteredTopics[aTopic] != nullptr && admit(sTopicLimits[aTopic], aTaskId, aTopic)) {
+        return LogShiftChainHelper{aTaskId, aTopic};
+      }
+      else {
+        return LogShiftChainHelper{csInvalidTaskId};
+      }
+    }
+    else {
+      return LogShiftChainHelper{csInvalidTaskId};
+    }
+  }
+
+  static LogShiftChainHelper n(RateLimit &aLimit) noexcept {
+    if constexpr(!csShutdownLog) {
+      TaskId const taskId = tAppInterface::getCurrentTaskId();
+      return LogShiftChainHelper{admit(aLimit, taskId, csInvalidTopic) ? taskId : csInvalidTaskId};
+    }
+    else {
+      return LogShiftChainHelper{csInvalidTaskId};
+    }
+  }
+
+  static LogShiftChainHelper n(LogTopic const aTopic, RateLimit &aLimit) noexcept {
     if constexpr(!csShutdownLog) {
       if(sRegisteredTopics[aTopic] != nullptr) {
-        return LogShiftChainHelper{aTaskId};
+        TaskId const taskId = tAppInterface::getCurrentTaskId();
+        return LogShiftChainHelper{admit(sTopicLimits[aTopic], taskId, aTopic) && admit(aLimit, taskId, aTopic) ? taskId : csInvalidTaskId, aTopic};
       }
       else {
         return LogShiftChainHelper{csInvalidTaskId};
@@ -610,8 +1148,90 @@ public:
   }
 
 private:
-  static LogShiftChainHelper sendHeader(TaskId const aTaskId) noexcept {
-    LogShiftChainHelper result{aTaskId};
+  /// Checked before any header work. The lines suppressed since the last
+  /// summary are reported right before an admitted one, so the summaries come
+  /// periodically as long as the limited code keeps logging. If it stops,
+  /// the transmitter reports the rest when idle, see reportSuppressions().
+  static bool admit(RateLimit &aLimit, TaskId const aTaskId, LogTopic const aTopic) noexcept {
+    bool const result = aLimit.admit();
+    if(result) {
+      uint32_t const suppressed = aLimit.takeSuppressedCount(static_cast<LogTime>(sConfig->suppressionReportPeriod));
+      if(suppressed > 0u) {
+        sendHeader(aTaskId, aTopic, aTopic == csInvalidTopic ? nullptr : sRegisteredTopics[aTopic]) << csSuppressed << suppressed << csSuppressedLines << end;
+      }
+      else { // nothing to do
+      }
+    }
+    else if(aLimit.noteSuppression(aTopic)) {
+      RateLimit *head = sListedLimits.load(std::memory_order_relaxed);
+      do {
+        aLimit.setNextListed(head);
+      } while(!sListedLimits.compare_exchange_weak(head, &aLimit, std::memory_order_release, std::memory_order_relaxed));
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Takes the lowest free group slot of the task, so a task may build
+  /// several groups at the same time, like when an argument of the chain
+  /// logs itself. Interrupts share a task ID, so this is lock-free.
+  /// Returns csInvalidGroupSlot if all are in use, and the group is dropped.
+  static GroupSlot acquireGroupSlot(TaskId const aTaskId, LogTopic const aTopic) noexcept {
+    GroupSlot result = csInvalidGroupSlot;
+    if(aTaskId != csInvalidTaskId) {
+      auto &slots = (*sGroupSlots)[aTaskId];
+      uint32_t used = slots.load(std::memory_order_relaxed);
+      while(result == csInvalidGroupSlot && (used & csAllGroupSlots) != csAllGroupSlots) {
+        GroupSlot const free = static_cast<GroupSlot>(std::countr_one(used));
+        uint32_t const bit = 1u << free;
+        if(slots.compare_exchange_weak(used, (used | bit) ^ (bit << csGroupSlotCount), std::memory_order_relaxed)) {
+          result = free;
+        }
+        else { // used was reloaded, try again
+        }
+      }
+      if(result == csInvalidGroupSlot) {
+        tStatistics::dropped(aTaskId, aTopic, 1u);
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Like acquireGroupSlot, but for the buffers of the current thread in direct mode.
+  static GroupSlot acquireDirectBuffer(TaskId const aTaskId, LogTopic const aTopic) noexcept {
+    GroupSlot result = csInvalidGroupSlot;
+    if(aTaskId != csInvalidTaskId) {
+      uint32_t const used = shDirectBuffers.mUsedSlots;
+      if(used != csAllGroupSlots) {
+        result = static_cast<GroupSlot>(std::countr_one(used));
+        shDirectBuffers.mUsedSlots = used | (1u << result);
+      }
+      else {
+        tStatistics::dropped(aTaskId, aTopic, 1u);
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Only the owner of the slot toggles its generation, so it reads back its own.
+  static MessageSequence getGenerationFlag(TaskId const aTaskId, GroupSlot const aGroupSlot) noexcept {
+    bool const generation = ((*sGroupSlots)[aTaskId].load(std::memory_order_relaxed) >> (aGroupSlot + csGroupSlotCount)) & 1u;
+    return generation ? tMessage::csGenerationFlag : 0u;
+  }
+
+  static void releaseGroupSlot(TaskId const aTaskId, GroupSlot const aGroupSlot) noexcept {
+    (*sGroupSlots)[aTaskId].fetch_and(~(1u << aGroupSlot), std::memory_order_relaxed);
+  }
+
+  static LogShiftChainHelper sendHeader(TaskId const aTaskId, LogTopic const aTopic = csInvalidTopic) noexcept {
+    LogShiftChainHelper result{aTaskId, aTopic};
     if(result.isValid()) {
       if constexpr(tTaskRepresentation == TaskRepresentation::cId) {
         result << sConfig->taskIdFormat << aTaskId;
@@ -627,7 +1247,12 @@ private:
       else { // nothing to do
       }
       if (sConfig->tickFormat.isValid()) {
-        result << sConfig->tickFormat << tAppInterface::getLogTime();
+        if constexpr(csSendInBackground) {
+          result << (sConfig->deduplicate ? sConfig->tickFormat.asHeaderTick() : sConfig->tickFormat) << tAppInterface::getLogTime();
+        }
+        else {
+          result << sConfig->tickFormat << tAppInterface::getLogTime();
+        }
       }
       else { // nothing to do
       }
@@ -637,8 +1262,8 @@ private:
     return result;
   }
 
-  static LogShiftChainHelper sendHeader(TaskId const aTaskId, char const * aTopicName) noexcept {
-    LogShiftChainHelper result = sendHeader(aTaskId);
+  static LogShiftChainHelper sendHeader(TaskId const aTaskId, LogTopic const aTopic, char const * aTopicName) noexcept {
+    LogShiftChainHelper result = sendHeader(aTaskId, aTopic);
     if(result.isValid() && aTopicName != nullptr) {
       result << aTopicName;
     }
@@ -647,14 +1272,125 @@ private:
     return result;
   }
 
+  /// Resets the state a previous owner of the ID may have left.
+  static void taskRegistered(TaskId const aTaskId, char const * const aTaskName) noexcept {
+    if constexpr(csSendInBackground) {
+      (*sTaskShutdowns)[aTaskId] = TaskShutdown::cNone;
+      (*sGroupSlots)[aTaskId] = 0u;    // A previous owner may have left some in use.
+    }
+    else { // nothing to do
+    }
+    if(sConfig->allowRegistrationLog) {
+      if constexpr(csConstantTaskNames) {
+        n(aTaskId) << csRegisteredTask << aTaskName << aTaskId << end;
+      }
+      else { // The name may be a temporary, like in auto-registration.
+        n(aTaskId) << csRegisteredTask << LogConfig::St << aTaskName << aTaskId << end;
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Registers threads of tAppInterface::csAutoRegister on their first log
+  /// call. Running out of IDs is not fatal here, the logging is just skipped.
+  static TaskId autoRegisterCurrentTask(char const * const aTaskName) noexcept {
+    TaskId const taskId = tAppInterface::registerCurrentTask(aTaskName);
+    if(taskId != csInvalidTaskId) {
+      taskRegistered(taskId, aTaskName);
+    }
+    else { // nothing to do
+    }
+    return taskId;
+  }
+
+  /// Called on exit of threads registered with tAppInterface::csAutoRegister.
+  /// The ID can be reused only after the transmitter has processed the
+  /// messages of the thread, so this goes through the queue like unregistering.
+  static void taskExited(TaskId const aTaskId) noexcept {
+    if constexpr(csSendInBackground) {
+      (*sTaskShutdowns)[aTaskId] = TaskShutdown::cRelease;
+      tMessage message;
+      message.setShutdown(aTaskId);
+      pushShutdown(message);
+    }
+    else {
+      tAppInterface::releaseTaskId(aTaskId);
+    }
+  }
+
+  /// Losing it would make the waiting task hang or leak the task ID.
+  static void pushShutdown(tMessage const &aMessage) noexcept {
+    bool success = false;
+    while(!success) {
+      success = tQueue::push(aMessage);
+      tStatistics::pushed(aMessage.getTaskId(), success);
+      if(!success) {
+        tAppInterface::sleepWhileWaitingForTaskShutdown();
+      }
+      else { // nothing to do
+      }
+    }
+  }
+
+  static void shutdown(TaskId const aTaskId) noexcept {
+    tStatistics::taskReleased(aTaskId);
+    if(sRepetitions != nullptr) {   // The ID may be reused.
+      reportRepetition(aTaskId);
+      (*sRepetitions)[aTaskId].mValid = false;
+    }
+    else { // nothing to do
+    }
+    if(sGroupStates != nullptr) {
+      (*sGroupStates)[aTaskId].mStale = false;
+      auto const table = (*sGroupSlotTables)[aTaskId];
+      if(table != nullptr) {
+        for(auto &state : table->mGroupStates) {
+          state.mStale = false;
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    if constexpr(csAutoRegister) {
+      if((*sTaskShutdowns)[aTaskId] == TaskShutdown::cRelease) {
+        (*sTaskShutdowns)[aTaskId] = TaskShutdown::cNone;
+        tAppInterface::releaseTaskId(aTaskId);
+      }
+      else {
+        (*sTaskShutdowns)[aTaskId] = TaskShutdown::cDone;
+        tAppInterface::notifyTaskShutdown((*sTaskShutdowns)[aTaskId]);
+      }
+    }
+    else {
+      (*sTaskShutdowns)[aTaskId] = TaskShutdown::cDone;
+      tAppInterface::notifyTaskShutdown((*sTaskShutdowns)[aTaskId]);
+    }
+  }
+
   static void transmitterTaskFunction() noexcept {
     while(sKeepAliveTask || !tQueue::empty()) {
+      if(sEmergency) { // emergencyDrain() takes over, the process is about to die.
+        sTransmitterParked = true;
+        while(true) {
+          tAppInterface::sleepWhileWaitingForTaskShutdown();
+        }
+      }
+      else { // nothing to do
+      }
       tMessage message;
       if(tQueue::pop(message, tRefreshPeriod)) {
+        tStatistics::popped();
         TaskId taskId = message.getTaskId();
         if constexpr(csSendInBackground) {
           if (message.isShutdown()) {
-            (*sTaskShutdowns)[taskId] = true;
+            if(taskId != csInvalidTaskId) {
+              shutdown(taskId);
+            }
+            else { // Wake-up by emergencyDrain(), the loop parks next.
+            }
           }
           else {
             checkAndInsertAndTransmit(taskId, message);
@@ -664,40 +1400,217 @@ private:
           checkAndInsertAndTransmit(taskId, message);
         }
       }
+      else { // Queue was idle for tRefreshPeriod, let buffering senders write what they have.
+        reportRepetitions();
+        reportSuppressions(static_cast<LogTime>(sConfig->suppressionReportPeriod));
+        flushSender();
+      }
+      flushStaleGroups();
+      if constexpr(tStatistics::csEnabled) {
+        reportStatistics();
+      }
       else { // nothing to do
       }
     }
+    reportRepetitions();
+    reportSuppressions(0u);
     tAppInterface::finish();
   }
 
+  /// Converts each report line right into the sender buffer, so it does not
+  /// touch the queue or the pool it reports on.
+  static void reportStatistics() noexcept {
+    LogTopic const topic = sStatisticsTopic.load(std::memory_order_acquire);
+    LogTime const now = tAppInterface::getLogTime();
+    if(topic != csInvalidTopic && now - sLastStatisticsReport >= sStatisticsReportPeriod) {
+      sLastStatisticsReport = now;
+      auto const snapshot = getStatistics();
+      for(size_t line = 0u; line < tStatistics::csReportLineCount; ++line) {
+        auto [begin, end] = tSender::getBuffer();
+        tConverter converter(begin, end);
+        if (sConfig->tickFormat.isValid()) {
+          converter.convert(now, sConfig->tickFormat.mBase, sConfig->tickFormat.mFill);
+        }
+        else { // nothing to do
+        }
+        converter.convert(sRegisteredTopics[topic], sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+        tStatistics::outputReportLine(converter, snapshot, line);
+        converter.terminateSequence();
+        send(begin, converter.end(), topic);
+      }
+      flushSender();
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// When the queue runs empty, the sender is flushed only if the last flush
+  /// was at least tRefreshPeriod ago, so a trickle of lines does not cost a
+  /// write each. Otherwise the idle pop flushes after tRefreshPeriod at most.
+  static void flushSender() noexcept {
+    tSender::flush();
+    sLastFlush = tAppInterface::getLogTime();
+  }
+
   static void checkAndInsertAndTransmit(TaskId const aTaskId, tMessage const &aMessage) noexcept {
-    auto list = (*sMessageQueues)[aTaskId];
+    if(aMessage.getMessageSequence() == csSequence0) {
+      tStatistics::groupArrived(aTaskId);
+    }
+    else { // nothing to do
+    }
+    auto list = getMessageQueue(aMessage);
+    if (insert(*list, aMessage)) {
+      transmit(*list);
+      if(tQueue::empty() && static_cast<LogTime>(tAppInterface::getLogTime() - sLastFlush) >= tRefreshPeriod) {
+        flushSender(); // No more groups to coalesce with for now, and the last flush was long ago.
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Does not create the list nor the slot table, so it is safe in emergencyDrain().
+  static MessageQueue* findMessageQueue(TaskId const aTaskId, GroupSlot const aGroupSlot) noexcept {
+    MessageQueue *result = nullptr;
+    if(aGroupSlot == 0u) {
+      result = (*sMessageQueues)[aTaskId];
+    }
+    else {
+      auto const table = (*sGroupSlotTables)[aTaskId];
+      result = (table == nullptr ? nullptr : table->mMessageQueues[aGroupSlot - 1u]);
+    }
+    return result;
+  }
+
+  /// Calls aFunction(taskId, slot, list) for each list created so far.
+  template<typename tFunction>
+  static void forEachMessageQueue(tFunction const aFunction) noexcept {
+    for(size_t taskId = 0u; taskId < csMaxTotalTaskCount; ++taskId) {
+      for(GroupSlot slot = 0u; slot < csGroupSlotCount; ++slot) {
+        auto const list = findMessageQueue(static_cast<TaskId>(taskId), slot);
+        if(list != nullptr) {
+          aFunction(static_cast<TaskId>(taskId), slot, *list);
+        }
+        else { // nothing to do
+        }
+      }
+    }
+  }
+
+  /// Only for existing lists, so the slot table is there for slots other than the first.
+  static GroupState& getGroupState(TaskId const aTaskId, GroupSlot const aGroupSlot) noexcept {
+    return aGroupSlot == 0u ? (*sGroupStates)[aTaskId] : (*sGroupSlotTables)[aTaskId]->mGroupStates[aGroupSlot - 1u];
+  }
+
+  /// Only the transmitter calls it, so the lazy creation needs no synchronization.
+  static MessageQueue* getMessageQueue(tMessage const &aMessage) {
+    TaskId const taskId = aMessage.getTaskId();
+    GroupSlot const slot = aMessage.getGroupSlot();
+    MessageQueue **place;
+    if(slot == 0u) {
+      place = &(*sMessageQueues)[taskId];
+    }
+    else {
+      auto &table = (*sGroupSlotTables)[taskId];
+      if(table == nullptr) {
+        table = tAppInterface::template _new<GroupSlotTable>();
+        table->mMessageQueues.fill(nullptr);
+        table->mGroupStates.fill(GroupState{0u, false, false});
+      }
+      else { // nothing to do
+      }
+      place = &table->mMessageQueues[slot - 1u];
+    }
+    auto &result = *place;
+    if(result == nullptr) {
+      result = tAppInterface::template _new<MessageQueue>(*sAllocator);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Returns true if the group is complete.
+  static bool insert(MessageQueue &aList, tMessage const &aMessage) noexcept {
     bool ready = false;
     auto sequence = aMessage.getMessageSequence();
-    if(list->empty()) {
-      if(sequence <= csSequence1 && sAllocator->hasFree()) {
-        ready = push(*list, aMessage, sequence);
+    if(aList.empty()) {
+      if(isRestOfStale(aMessage)) {
+        tStatistics::dropped(aMessage.getTaskId(), aMessage.getTopic(), 1u);
       }
-      else { // nothing to do
+      else if(sequence > csSequence1) {
+        tStatistics::sequenceGap();
+        tStatistics::dropped(aMessage.getTaskId(), aMessage.getTopic(), 1u);
+      }
+      else if(hasRoom(aMessage)) {
+        ready = push(aList, aMessage, sequence);
+      }
+      else {
+        tStatistics::dropped(aMessage.getTaskId(), aMessage.getTopic(), 1u);
       }
     }
     else {
-      auto lastSequence = list->back().getMessageSequence();
-      if((sequence == csSequence0 || sequence == lastSequence + 1u) && sAllocator->hasFree()) {
-        ready = push(*list, aMessage, sequence);
+      auto lastSequence = aList.back().getMessageSequence();
+      if(sequence != csSequence0 && sequence != lastSequence + 1u) {
+        tStatistics::sequenceGap();
+        discard(aList, aMessage);
+      }
+      else if(hasRoom(aMessage)) {
+        ready = push(aList, aMessage, sequence);
       }
       else {
-        list->clear();
+        discard(aList, aMessage);
       }
     }
-    if (ready) {
-      transmit(*list);
+    return ready;
+  }
+
+  static bool hasRoom(tMessage const &aMessage) noexcept {
+    bool result = false;
+    uint32_t const quota = (*sTaskPoolQuotas)[aMessage.getTaskId()].load(std::memory_order_relaxed);
+    if(!sAllocator->hasFree()) {
+      tStatistics::poolExhausted();
     }
-    else { // nothing to do
+    else if(quota > 0u && getPoolUsage(aMessage.getTaskId()) >= quota) {
+      tStatistics::quotaExceeded(aMessage.getTaskId(), aMessage.getTopic());
     }
+    else {
+      result = true;
+    }
+    return result;
+  }
+
+  /// The lists hold the partial groups of the task, so their sizes add up to what the task has in the pool.
+  static size_t getPoolUsage(TaskId const aTaskId) noexcept {
+    size_t result = 0u;
+    for(GroupSlot slot = 0u; slot < csGroupSlotCount; ++slot) {
+      auto list = findMessageQueue(aTaskId, slot);
+      result += (list == nullptr ? 0u : list->size());
+    }
+    return result;
+  }
+
+  /// The message revealing the problem is lost as well.
+  static void discard(MessageQueue &aList, tMessage const &aMessage) noexcept {
+    tStatistics::groupDiscarded();
+    tStatistics::dropped(aMessage.getTaskId(), aMessage.getTopic(), aList.size() + 1u);
+    clear(aList);
+  }
+
+  static void clear(MessageQueue &aList) noexcept {
+    tStatistics::poolReleased(aList.size());
+    aList.clear();
   }
 
   static bool push(MessageQueue &aList, tMessage const &aMessage, MessageSequence const aSequence) noexcept {
+    tStatistics::poolAcquired();
+    if(sGroupStates != nullptr && aList.empty()) {
+      getGroupState(aMessage.getTaskId(), aMessage.getGroupSlot()).mStart = tAppInterface::getLogTime();
+    }
+    else { // nothing to do
+    }
     bool result;
     if(aSequence == csSequence0) {
       aList.push_front(aMessage);
@@ -711,14 +1624,246 @@ private:
   }
 
   static void transmit(MessageQueue &aList) noexcept {
-    auto [begin, end] = tSender::getBuffer();
-    tConverter converter(begin, end);
+    if(sRepetitions == nullptr || !isRepeated(aList)) {
+      LogTopic const topic = aList.front().getTopic();
+      TaskId const taskId = aList.front().getTaskId();
+      size_t const messageCount = aList.size();
+      StreamingConversion conversion(topic);
+      tStatistics::convertStarting();
+      convert(conversion, aList);
+      clear(aList);
+      tStatistics::sendStarting();
+      conversion.finish();
+      tStatistics::groupTransmitted(taskId, topic, messageCount, conversion.getLength());
+    }
+    else {
+      clear(aList);
+    }
+  }
+
+  static void convert(StreamingConversion &aConversion, MessageQueue const &aList) noexcept {
+    size_t const maxLength = sConfig->maxGroupLength;
+    for(auto const &message : aList) {
+      if(maxLength > 0u && aConversion.getLength() >= maxLength) {
+        aConversion.append([](tConverter &aConverter){ aConverter.convert(csTruncated, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill); });
+        break;
+      }
+      else {
+        aConversion.append([&message](tConverter &aConverter){ message.template output<tConverter>(aConverter); });
+      }
+    }
+  }
+
+  /// Checks at most once in tRefreshPeriod, so a busy queue costs only a time query per message.
+  static void flushStaleGroups() noexcept {
+    if(sGroupStates != nullptr) {
+      LogTime const now = tAppInterface::getLogTime();
+      if(static_cast<LogTime>(now - sLastStaleCheck) >= tRefreshPeriod) {
+        sLastStaleCheck = now;
+        forEachMessageQueue([now](TaskId const aTaskId, GroupSlot const aGroupSlot, MessageQueue &aList){
+          if(!aList.empty()) {
+            GroupState &state = getGroupState(aTaskId, aGroupSlot);
+            if(static_cast<LogTime>(now - state.mStart) >= static_cast<LogTime>(sConfig->staleGroupTimeout)) {
+              state.mGeneration = aList.front().getGeneration();
+              transmitStale(aList, aTaskId);
+              state.mStale = true;
+            }
+            else { // nothing to do
+            }
+          }
+          else { // nothing to do
+          }
+        });
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Partial groups lack their first item, so they are marked with the task ID instead.
+  static void transmitStale(MessageQueue &aList, TaskId const aTaskId) noexcept {
+    LogTopic const topic = aList.front().getTopic();
+    size_t const messageCount = aList.size();
+    StreamingConversion conversion(topic);
+    tStatistics::convertStarting();
+    conversion.append([](tConverter &aConverter){ aConverter.convert(csStaleGroup, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill); });
+    conversion.append([aTaskId](tConverter &aConverter){ aConverter.convert(aTaskId, sConfig->taskIdFormat.mBase, sConfig->taskIdFormat.mFill); });
+    convert(conversion, aList);
+    clear(aList);
+    tStatistics::sendStarting();
+    conversion.finish();
+    tStatistics::groupTransmitted(aTaskId, topic, messageCount, conversion.getLength());
+    flushSender();
+  }
+
+  /// After a stale group was flushed, the rest of it arriving later is
+  /// dropped up to its first message, which the task sends last. The rest
+  /// has the generation of the flushed part, while the next group in the
+  /// slot has the other one, even if the first message of the stale group
+  /// never arrives.
+  static bool isRestOfStale(tMessage const &aMessage) noexcept {
+    bool result = false;
+    if(sGroupStates != nullptr) {
+      GroupState &state = getGroupState(aMessage.getTaskId(), aMessage.getGroupSlot());
+      if(state.mStale) {
+        result = (aMessage.getGeneration() == state.mGeneration);
+        if(!result || aMessage.getMessageSequence() == csSequence0) {
+          state.mStale = false;
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// The first of identical lines goes out, the repetitions are only counted
+  /// and reported periodically, or when the task logs something else.
+  static bool isRepeated(MessageQueue const &aList) noexcept {
+    TaskId const taskId = aList.front().getTaskId();
+    LogTopic const topic = aList.front().getTopic();
+    uint64_t const hash = hashGroup(aList);
+    Repetition &repetition = (*sRepetitions)[taskId];
+    bool result;
+    if(repetition.mValid && repetition.mHash == hash && repetition.mTopic == topic) {
+      LogTime const now = tAppInterface::getLogTime();
+      if(repetition.mCount == 0u) {
+        repetition.mSince = now;
+      }
+      else { // nothing to do
+      }
+      ++repetition.mCount;
+      if(static_cast<LogTime>(now - repetition.mSince) >= static_cast<LogTime>(sConfig->suppressionReportPeriod)) {
+        reportRepetition(taskId);
+      }
+      else { // nothing to do
+      }
+      result = true;
+    }
+    else {
+      reportRepetition(taskId);
+      repetition.mHash = hash;
+      repetition.mCount = 0u;
+      repetition.mTopic = topic;
+      repetition.mValid = true;
+      result = false;
+    }
+    return result;
+  }
+
+  /// FNV-1a of the converted items, apart from the tick in the header.
+  /// Converting in a stack buffer is cheaper than sending the repetitions.
+  static uint64_t hashGroup(MessageQueue const &aList) noexcept {
+    uint64_t result = csFnvOffsetBasis;
+    ConversionResult buffer[csDeduplicationBufferSize];
+    for(auto const &message : aList) {
+      if(!message.isHeaderTick()) {
+        tConverter converter(buffer, buffer + csDeduplicationBufferSize);
+        message.template output<tConverter>(converter);
+        auto const *bytes = reinterpret_cast<unsigned char const *>(buffer);
+        auto const *end = reinterpret_cast<unsigned char const *>(converter.end());
+        for(; bytes < end; ++bytes) {
+          result = (result ^ *bytes) * csFnvPrime;
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    return result;
+  }
+
+  static void reportRepetition(TaskId const aTaskId) noexcept {
+    Repetition &repetition = (*sRepetitions)[aTaskId];
+    if(repetition.mCount > 0u) {
+      auto [begin, end] = tSender::getBuffer();
+      tConverter converter(begin, end);
+      converter.convert(csRepeatedLine, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+      converter.convert(aTaskId, sConfig->taskIdFormat.mBase, sConfig->taskIdFormat.mFill);
+      converter.convert(csRepeated, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+      converter.convert(repetition.mCount, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+      converter.convert(csRepeatedTimes, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+      converter.terminateSequence();
+      send(begin, converter.end(), repetition.mTopic);
+      repetition.mCount = 0u;
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void reportRepetitions() noexcept {
+    if(sRepetitions != nullptr) {
+      for(TaskId taskId = 0u; taskId < csMaxTotalTaskCount; ++taskId) {
+        reportRepetition(taskId);
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Reports the lines suppressed by rate limits whose code stopped logging,
+  /// with the tick and the topic, as there is no task to put in the header.
+  static void reportSuppressions(LogTime const aReportPeriod) noexcept {
+    for(RateLimit *limit = sListedLimits.load(std::memory_order_acquire); limit != nullptr; limit = limit->getNextListed()) {
+      uint32_t const suppressed = limit->takeSuppressedCount(aReportPeriod);
+      if(suppressed > 0u) {
+        LogTopic const topic = limit->getTopic();
+        auto [begin, end] = tSender::getBuffer();
+        tConverter converter(begin, end);
+        if (sConfig->tickFormat.isValid()) {
+          converter.convert(tAppInterface::getLogTime(), sConfig->tickFormat.mBase, sConfig->tickFormat.mFill);
+        }
+        else { // nothing to do
+        }
+        if(topic != csInvalidTopic && sRegisteredTopics[topic] != nullptr) {
+          converter.convert(sRegisteredTopics[topic], sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+        }
+        else { // nothing to do
+        }
+        converter.convert(csSuppressed, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+        converter.convert(suppressed, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+        converter.convert(csSuppressedLines, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+        converter.terminateSequence();
+        send(begin, converter.end(), topic);
+      }
+      else { // nothing to do
+      }
+    }
+  }
+
+  /// Converts in a stack buffer. Partial groups lack their first item, so
+  /// they are marked with the task ID instead.
+  static void emergencyTransmit(MessageQueue &aList, TaskId const aTruncatedTaskId) noexcept {
+    ConversionResult buffer[csEmergencyBufferSize];
+    tConverter converter(buffer, buffer + csEmergencyBufferSize);
+    if(aTruncatedTaskId != csInvalidTaskId) {
+      converter.convert(csTruncatedGroup, sConfig->defaultFormat.mBase, sConfig->defaultFormat.mFill);
+      converter.convert(aTruncatedTaskId, sConfig->taskIdFormat.mBase, sConfig->taskIdFormat.mFill);
+    }
+    else { // nothing to do
+    }
     for(auto &message : aList) {
       message.template output<tConverter>(converter);
     }
-    aList.clear();
+    clear(aList);
     converter.terminateSequence();
-    tSender::send(begin, converter.end());
+    tAppInterface::emergencyWrite(buffer, converter.end());
+  }
+
+  /// Senders routing by topic receive the topic of the group as well.
+  static void send(ConversionResult const * const aBegin, ConversionResult const * const aEnd, LogTopic const aTopic) {
+    tStatistics::sent(aEnd - aBegin);
+    if constexpr(csSenderTakesTopic) {
+      tSender::send(aBegin, aEnd, aTopic);
+    }
+    else {
+      tSender::send(aBegin, aEnd);
+    }
   }
 };
 
@@ -20,11 +20,15 @@ template<TaskId tMaxTaskCount, bool tLogFromIsr, size_t tTaskShutdownPollPeriod>
 class AppInterfaceFreeRtosMinimal final {
 public:
   using LogTime = uint32_t;
+  using PerformanceTime = uint32_t;
   static constexpr TaskId csMaxTaskCount      = tMaxTaskCount; // Exported just to let the Log de checks.
   static constexpr TaskId csInvalidTaskId     = std::numeric_limits<TaskId>::max();
   static constexpr TaskId csIsrTaskId         = std::numeric_limits<TaskId>::min();
   static constexpr TaskId csFirstNormalTaskId = csIsrTaskId + 1u;
   static constexpr bool   csConstantTaskNames = true;
+  static constexpr bool   csAutoRegister      = false;      // Tasks are created beforehand and register themselves.
+  static constexpr bool   csLogFromIsr        = tLogFromIsr;
+  static constexpr bool   csLockFromIsr       = true;       // lock() does nothing.
 
   class Occupier final {
   public:
@@ -95,6 +99,14 @@ public:
     return result;
   }
 
+  static bool isCurrentTaskRegistered() {
+    xSemaphoreTake(sRegistrationMutex, csRegistrationMutexTimeout);
+    auto end = sTaskHandles.begin() + sPreviousTaskId;
+    bool const result = std::find(sTaskHandles.begin(), end, xTaskGetCurrentTaskHandle()) != end;
+    xSemaphoreGive(sRegistrationMutex);
+    return result;
+  }
+
   static TaskId registerCurrentTask(char const * const) {
     xSemaphoreTake(sRegistrationMutex, csRegistrationMutexTimeout);
     TaskId result;
@@ -143,6 +155,11 @@ public:
     return portTICK_PERIOD_MS * xTaskGetTickCount();
   }
 
+  /// Microseconds for statistics, but only with tick resolution. A cycle counter would be better, but it is MCU-specific.
+  static PerformanceTime getPerformanceTime() noexcept {
+    return portTICK_PERIOD_MS * xTaskGetTickCount() * 1000u;
+  }
+
   static void finish() noexcept { // We assume everything runs forever.
   }
 
@@ -153,6 +170,16 @@ public:
     vTaskDelay(tTaskShutdownPollPeriod / portTICK_PERIOD_MS);
   }
 
+  /// Unregistering is not supported here anyway, so polling is fine.
+  template<typename tState>
+  static void waitForTaskShutdown(std::atomic<tState> &, tState const) noexcept {
+    sleepWhileWaitingForTaskShutdown();
+  }
+
+  template<typename tState>
+  static void notifyTaskShutdown(std::atomic<tState> &) noexcept { // nothing to do
+  }
+
 
   static void lock() noexcept { // Now don't care.
   }
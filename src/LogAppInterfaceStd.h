@@ -3,23 +3,34 @@
 
 #include "Log.h"
 #include <ios>
+#include <bit>
 #include <mutex>
 #include <chrono>
 #include <thread>
-#include <unordered_set>
+#include <csignal>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <pthread.h>
 #include <condition_variable>
 
 namespace nowtech::log {
 
-template<TaskId tMaxTaskCount, bool tLogFromIsr, size_t tTaskShutdownPollPeriod>
+/// With tAutoRegister, threads are registered on their first log call and
+/// their ID is recycled when they exit, see getCurrentTaskId.
+template<TaskId tMaxTaskCount, bool tLogFromIsr, size_t tTaskShutdownPollPeriod, bool tAutoRegister = false>
 class AppInterfaceStd final {
 public:
   using LogTime = uint32_t;
+  using PerformanceTime = uint32_t;
   static constexpr TaskId csMaxTaskCount      = tMaxTaskCount; // Exported just to let the Log de checks.
   static constexpr TaskId csInvalidTaskId     = std::numeric_limits<TaskId>::max();
   static constexpr TaskId csIsrTaskId         = std::numeric_limits<TaskId>::min();
   static constexpr TaskId csFirstNormalTaskId = csIsrTaskId + 1u;
   static constexpr bool   csConstantTaskNames = false;
+  static constexpr bool   csAutoRegister      = tAutoRegister;
+  static constexpr bool   csLogFromIsr        = tLogFromIsr;
+  static constexpr bool   csLockFromIsr       = false;      // lock() is a mutex, which may deadlock in a signal handler.
 
   class Occupier final {
   public:
@@ -70,20 +81,53 @@ private:
   inline static constexpr char   csUnknownTaskName[]  = "UNKNOWN";
   inline static constexpr char   csIsrTaskName[]      = "ISR";
   inline static constexpr size_t csTaskId2threadsSize = csMaxTaskCount + 1u;
+  inline static constexpr size_t csBitsPerWord        = std::numeric_limits<uint64_t>::digits;
+  inline static constexpr size_t csFreeTaskIdWords    = (csTaskId2threadsSize + csBitsPerWord - 1u) / csBitsPerWord;
+  inline static constexpr size_t csMaxThreadNameLength = 16u;   // Including the terminating 0, see pthread_getname_np.
+  inline static constexpr size_t csMaxTaskNameLength   = 32u;   // Including the terminating 0, longer names are truncated.
   inline static const std::thread::id csNoThreadId;
 
+  /// Calls the task exit hook for the ID the thread still holds when it exits.
+  class TaskExitGuard final {
+  public:
+    TaskId mTaskId = csInvalidTaskId;
+
+    ~TaskExitGuard() noexcept {
+      auto hook = sTaskExitHook.load();
+      if(mTaskId != csInvalidTaskId && hook != nullptr) {
+        hook(mTaskId);
+      }
+      else { // nothing to do
+      }
+    }
+  };
+
   inline static thread_local TaskId shTaskId = csInvalidTaskId;
-  inline static thread_local std::string shTaskName;
-  inline static std::unordered_set<TaskId> sFreeTaskIds;
-  inline static std::mutex sRegistrationMutex;
+  inline static thread_local uint32_t shIsrDepth = 0u;    // Trivial, so safe to access in signal handlers of the executable.
+  inline static thread_local char shTaskName[csMaxTaskNameLength];
+  inline static thread_local TaskExitGuard shTaskExitGuard;
+  inline static thread_local uint32_t shFailedAtRelease = std::numeric_limits<uint32_t>::max();  // sReleaseCount at the last failed auto-registration.
+  inline static std::array<std::atomic<uint64_t>, csFreeTaskIdWords> sFreeTaskIds;  // A set bit means the ID is free.
+  inline static std::atomic<uint32_t> sReleaseCount = 0u;
+  inline static std::atomic<void(*)(TaskId)> sTaskExitHook = nullptr;
+  inline static std::atomic<TaskId(*)(char const *)> sTaskRegisterHook = nullptr;
+  inline static std::mutex sSendMutex;
   inline static std::thread *sTransmitterThread;
+
+  inline static constexpr int csFatalSignals[]      = { SIGSEGV, SIGABRT, SIGBUS };
+  inline static constexpr int csInvalidFd           = -1;
+  inline static int           sEmergencyFd          = csInvalidFd;
+  inline static void        (*sEmergencyDrain)()    = nullptr;
   
   AppInterfaceStd() = delete;
 
 public:
   static void init() {
-    for(TaskId id = csFirstNormalTaskId; id <= tMaxTaskCount; ++id) {
-      sFreeTaskIds.insert(id);
+    for(auto &word : sFreeTaskIds) {
+      word = 0u;
+    }
+    for(size_t id = csFirstNormalTaskId; id <= tMaxTaskCount; ++id) {
+      sFreeTaskIds[id / csBitsPerWord] |= uint64_t{1u} << (id % csBitsPerWord);
     }
   }
 
@@ -99,45 +143,144 @@ public:
     }
     else { // nothing to do
     }
-    sFreeTaskIds.clear();
   }
 
-  /// We assume it won't get called during registering.
+  /// Marks the scope of a signal handler, where logging happens with csIsrTaskId
+  /// through the async-signal-safe queue path. Nesting is allowed.
+  class IsrScope final {
+  public:
+    IsrScope() noexcept {
+      static_assert(tLogFromIsr);
+      ++shIsrDepth;
+    }
+
+    ~IsrScope() noexcept {
+      --shIsrDepth;
+    }
+
+    IsrScope(IsrScope const &) = delete;
+    IsrScope& operator=(IsrScope const &) = delete;
+  };
+
+  /// We assume it won't get called during registering. With tAutoRegister,
+  /// a thread without an ID gets one here, named after its native thread name,
+  /// through the register hook if set. Interrupt contexts never register.
+  /// If there was no free ID, the thread tries again only after an ID was
+  /// released, so running out of IDs does not slow down every log call.
   static TaskId getCurrentTaskId() noexcept {
-    return shTaskId;
+    TaskId result = shTaskId;
+    if constexpr(tLogFromIsr) {
+      if(shIsrDepth > 0u) {
+        result = csIsrTaskId;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    if constexpr(tAutoRegister) {
+      if(result == csInvalidTaskId) {
+        uint32_t const releaseCount = sReleaseCount.load(std::memory_order_acquire);
+        if(releaseCount != shFailedAtRelease) {
+          char name[csMaxThreadNameLength];
+          if(::pthread_getname_np(::pthread_self(), name, sizeof(name)) != 0) {
+            name[0] = 0;
+          }
+          else { // nothing to do
+          }
+          auto const hook = sTaskRegisterHook.load();
+          result = (hook != nullptr ? hook(name) : registerCurrentTask(name));
+          shFailedAtRelease = (result == csInvalidTaskId ? releaseCount : std::numeric_limits<uint32_t>::max());
+        }
+        else { // nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
   }
 
-  static TaskId registerCurrentTask(char const * const aTaskName) {
-    std::lock_guard<std::mutex> lock (sRegistrationMutex);
-    TaskId result;
-    if(!sFreeTaskIds.empty()) {
-      auto begin = sFreeTaskIds.begin();
-      shTaskId = result = *begin;
-      shTaskName = aTaskName;
-      sFreeTaskIds.erase(begin);
+  /// Does not register the thread, unlike getCurrentTaskId with tAutoRegister.
+  static bool isCurrentTaskRegistered() noexcept {
+    return shTaskId != csInvalidTaskId;
+  }
+
+  /// A thread registered already keeps its ID and only gets the new name.
+  /// Lock-free and does not allocate.
+  static TaskId registerCurrentTask(char const * const aTaskName) noexcept {
+    TaskId result = shTaskId;
+    if(result == csInvalidTaskId) {
+      result = claimTaskId();
+      shTaskId = result;
+    }
+    else { // nothing to do
     }
-    else {
-      result = csInvalidTaskId;
+    if(result != csInvalidTaskId) {
+      std::strncpy(shTaskName, (aTaskName != nullptr ? aTaskName : ""), csMaxTaskNameLength - 1u);
+      shTaskName[csMaxTaskNameLength - 1u] = 0;
+      if constexpr(tAutoRegister) {
+        shTaskExitGuard.mTaskId = result;   // The first access arranges the destructor call on thread exit.
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
     }
     return result;
   }
 
-  static TaskId unregisterCurrentTask() {
-    std::lock_guard<std::mutex> lock (sRegistrationMutex);
-    sFreeTaskIds.insert(shTaskId);
+  static TaskId unregisterCurrentTask() noexcept {
+    releaseTaskId(shTaskId);
     shTaskId = csInvalidTaskId;
+    if constexpr(tAutoRegister) {
+      shTaskExitGuard.mTaskId = csInvalidTaskId;
+    }
+    else { // nothing to do
+    }
     return csInvalidTaskId;
   }
 
+  /// Makes the ID available for registration again. Lock-free.
+  static void releaseTaskId(TaskId const aTaskId) noexcept {
+    if(aTaskId != csInvalidTaskId && aTaskId != csIsrTaskId) {
+      sFreeTaskIds[aTaskId / csBitsPerWord].fetch_or(uint64_t{1u} << (aTaskId % csBitsPerWord), std::memory_order_release);
+      sReleaseCount.fetch_add(1u, std::memory_order_release);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// With tAutoRegister, aHook is called with the ID of each registered
+  /// thread exiting without unregistering. The hook is responsible for
+  /// releasing the ID using releaseTaskId, when it is safe to reuse it.
+  static void setTaskExitHook(void (* const aHook)(TaskId)) noexcept {
+    sTaskExitHook = aHook;
+  }
+
+  /// With tAutoRegister, aHook registers threads logging without an ID
+  /// instead of registerCurrentTask, so the user of the ID can prepare it.
+  /// The hook must call registerCurrentTask and return its result.
+  static void setTaskRegisterHook(TaskId (* const aHook)(char const *)) noexcept {
+    sTaskRegisterHook = aHook;
+  }
+
   // Caller will copy contents from returned pointer immediately.
-  static char const * getTaskName(TaskId const) noexcept {
-    return shTaskName.c_str();
+  static char const * getTaskName(TaskId const aTaskId) noexcept {
+    return aTaskId == csIsrTaskId ? csIsrTaskName : shTaskName;
   }
 
   static LogTime getLogTime() noexcept {
     return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
   }
 
+  /// Microseconds for statistics, wraps around in about 71 minutes.
+  static PerformanceTime getPerformanceTime() noexcept {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
   static void finish() noexcept {
     sSemaphore.notify();
   }
@@ -150,10 +293,56 @@ public:
     std::this_thread::sleep_for(std::chrono::milliseconds(tTaskShutdownPollPeriod));
   }
 
-  static void lock() noexcept { // Now don't care.
+  /// Blocks until aState differs from aOld, typically on a futex, so the
+  /// unregistering thread wakes as soon as the transmitter notifies it.
+  template<typename tState>
+  static void waitForTaskShutdown(std::atomic<tState> &aState, tState const aOld) noexcept {
+    aState.wait(aOld);
+  }
+
+  template<typename tState>
+  static void notifyTaskShutdown(std::atomic<tState> &aState) noexcept {
+    aState.notify_all();
+  }
+
+  /// Opt-in: on SIGSEGV, SIGABRT or SIGBUS aDrain is called, which is meant
+  /// to be Log::emergencyDrain, writing its output to aFd using emergencyWrite.
+  /// Then the default action of the signal is performed.
+  static void installFatalSignalHandlers(int const aFd, void (* const aDrain)()) noexcept {
+    sEmergencyFd = aFd;
+    sEmergencyDrain = aDrain;
+    struct sigaction action {};
+    action.sa_handler = fatalSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESETHAND;
+    for(int const signal : csFatalSignals) {
+      ::sigaction(signal, &action, nullptr);
+    }
+  }
+
+  /// Async-signal-safe.
+  static void emergencyWrite(char const * const aBegin, char const * const aEnd) noexcept {
+    char const * where = aBegin;
+    while(sEmergencyFd != csInvalidFd && where < aEnd) {
+      ssize_t written = ::write(sEmergencyFd, where, aEnd - where);
+      if(written >= 0) {
+        where += written;
+      }
+      else if(errno != EINTR) {
+        break;
+      }
+      else { // nothing to do
+      }
+    }
+  }
+
+  /// Serializes sending in direct mode.
+  static void lock() noexcept {
+    sSendMutex.lock();
   }
 
-  static void unlock() noexcept { // Now don't care.
+  static void unlock() noexcept {
+    sSendMutex.unlock();
   }
 
   static void error(Exception const aError) {
@@ -164,6 +353,41 @@ public:
     throw std::ios_base::failure(csErrorMessages[static_cast<size_t>(aError)]);
   }
 
+private:
+  /// Takes the lowest free ID: finds the first set bit in a word and clears
+  /// it using CAS, retrying only if some other thread changed the same word.
+  static TaskId claimTaskId() noexcept {
+    TaskId result = csInvalidTaskId;
+    for(size_t i = 0u; result == csInvalidTaskId && i < csFreeTaskIdWords; ++i) {
+      uint64_t word = sFreeTaskIds[i].load(std::memory_order_relaxed);
+      while(word != 0u) {
+        int const bit = std::countr_zero(word);
+        if(sFreeTaskIds[i].compare_exchange_weak(word, word & ~(uint64_t{1u} << bit), std::memory_order_acquire, std::memory_order_relaxed)) {
+          result = static_cast<TaskId>(i * csBitsPerWord + bit);
+          break;
+        }
+        else { // word was reloaded, try again
+        }
+      }
+    }
+    return result;
+  }
+
+  /// The handler was reset to the default by SA_RESETHAND, and the signal
+  /// is blocked until we return, so raising it again terminates the process
+  /// the usual way, also when it was not caused by the faulting instruction.
+  static void fatalSignalHandler(int const aSignal) noexcept {
+    int const savedErrno = errno;
+    if(sEmergencyDrain != nullptr) {
+      sEmergencyDrain();
+    }
+    else { // nothing to do
+    }
+    errno = savedErrno;
+    ::raise(aSignal);
+  }
+
+public:
   template<typename tClass, typename ...tParameters>
   static tClass* _new(tParameters... aParameters) {
     return ::new tClass(aParameters...);
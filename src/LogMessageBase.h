@@ -3,6 +3,7 @@
 
 #include "LogNumericSystem.h"
 #include <limits>
+#include <type_traits>
 
 namespace nowtech::log {
 
@@ -10,6 +11,9 @@ struct LogFormat final {
 public:
   static constexpr uint8_t csFillValueStoreString = std::numeric_limits<uint8_t>::max();
   static constexpr uint8_t csFillValueStoreStringTerminal = csFillValueStoreString - 1u;
+  /// Set in the base of the tick in the header, so the transmitter can leave
+  /// it out when looking for repeated lines. Messages strip it on output.
+  static constexpr uint8_t csHeaderTickFlag = 0x80u;
 
   uint8_t mBase;
   uint8_t mFill;
@@ -19,7 +23,19 @@ public:
   }
 
   bool isValid() const noexcept {
-    return mBase > NumericSystem::csInvalid && mBase <= NumericSystem::csBaseMax;
+    return getBase() > NumericSystem::csInvalid && getBase() <= NumericSystem::csBaseMax;
+  }
+
+  uint8_t getBase() const noexcept {
+    return mBase & static_cast<uint8_t>(~csHeaderTickFlag);
+  }
+
+  bool isHeaderTick() const noexcept {
+    return (mBase & csHeaderTickFlag) != 0u;
+  }
+
+  LogFormat asHeaderTick() const noexcept {
+    return LogFormat{static_cast<uint8_t>(mBase | csHeaderTickFlag), mFill};
   }
 
   bool isStoredString() const noexcept {
@@ -27,8 +43,26 @@ public:
   }
 };
 
-using TaskId          = uint8_t;
-using MessageSequence = uint8_t;
+/// Define it as 16 before including any log header to support more than 254 tasks.
+#ifndef NOWTECH_LOG_TASK_ID_BITS
+#define NOWTECH_LOG_TASK_ID_BITS 8
+#endif
+
+static_assert(NOWTECH_LOG_TASK_ID_BITS == 8 || NOWTECH_LOG_TASK_ID_BITS == 16);
+
+/// Limits a group to 32765 items by default, as the top bit holds the
+/// generation of the group slot. Define it as 8 before including any log
+/// header to save a byte in each message, if no group is longer than 125 items.
+#ifndef NOWTECH_LOG_MESSAGE_SEQUENCE_BITS
+#define NOWTECH_LOG_MESSAGE_SEQUENCE_BITS 16
+#endif
+
+static_assert(NOWTECH_LOG_MESSAGE_SEQUENCE_BITS == 8 || NOWTECH_LOG_MESSAGE_SEQUENCE_BITS == 16);
+
+using TaskId          = std::conditional_t<NOWTECH_LOG_TASK_ID_BITS == 16, uint16_t, uint8_t>;
+using MessageSequence = std::conditional_t<NOWTECH_LOG_MESSAGE_SEQUENCE_BITS == 16, uint16_t, uint8_t>;
+using LogTopic        = int8_t; // this needs to be signed to let the overload resolution work
+using GroupSlot       = uint8_t;
 
 enum class ShutdownMessageContent : uint8_t {
   csSomething
@@ -38,6 +72,13 @@ template<std::size_t tPayloadSize, bool tSupportFloatingPoint>
 class MessageBase {
 public:
   static constexpr MessageSequence csTerminal = 0u;
+  /// The top bit of the stored sequence alternates with each group built in
+  /// the same group slot, so the transmitter can tell the rest of a group it
+  /// has flushed as stale from a new one. Messages strip it from the sequence.
+  static constexpr MessageSequence csGenerationFlag = static_cast<MessageSequence>(1u << (std::numeric_limits<MessageSequence>::digits - 1));
+  /// Number of groups a task may build at the same time. Messages carry the
+  /// slot of their group, so the transmitter collects them separately.
+  static constexpr GroupSlot csGroupSlotCount = 8u;
 
 protected:
   static_assert(!tSupportFloatingPoint || sizeof(float) <= tPayloadSize);
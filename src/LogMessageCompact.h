@@ -9,11 +9,15 @@
 namespace nowtech::log {
 
 // Will be copied via taking the data pointer. Here we go for size.
-template<size_t tPayloadSize, bool tSupportFloatingPoint>
+// The topic takes an extra byte, so it is stored only if tStoreTopic is true,
+// which Log requires for topic-aware senders and topic statistics.
+template<size_t tPayloadSize, bool tSupportFloatingPoint, bool tStoreTopic = false>
 class MessageCompact final : public MessageBase<tPayloadSize, tSupportFloatingPoint> {
 public:
   static constexpr size_t csPayloadSize = tPayloadSize + sizeof(uint8_t); // Antipattern to use the base field for storage, but we go for space saving.
   static constexpr bool   csSupportFloatingPoint = tSupportFloatingPoint;
+  static constexpr bool   csStoresTopic = tStoreTopic;
+  static constexpr MessageSequence csGenerationFlag = MessageBase<tPayloadSize, tSupportFloatingPoint>::csGenerationFlag;
 
 private:
   enum class Type : uint8_t {
@@ -21,14 +25,22 @@ private:
   };
 
   static constexpr MessageSequence csTerminal     = MessageBase<tPayloadSize, tSupportFloatingPoint>::csTerminal;
-  static constexpr size_t csTotalSize             = tPayloadSize + 2 * sizeof(uint8_t) + sizeof(TaskId) + sizeof(MessageSequence) + sizeof(Type);
+  /// The group slot is stored in the unused upper bits of the type.
+  static constexpr uint8_t csGroupSlotShift       = 5u;
+  static constexpr uint8_t csTypeMask             = (1u << csGroupSlotShift) - 1u;
+  static constexpr LogTopic csNoTopic             = std::numeric_limits<LogTopic>::min();
+  static constexpr size_t csTotalSize             = tPayloadSize + 2 * sizeof(uint8_t) + sizeof(TaskId) + sizeof(MessageSequence) + sizeof(Type) + (tStoreTopic ? sizeof(LogTopic) : 0u);
   static constexpr size_t csOffsetPayload         = 0u;
   static constexpr size_t csOffsetBase            = csOffsetPayload + tPayloadSize;
   static constexpr size_t csOffsetFill            = csOffsetBase + sizeof(uint8_t);
   static constexpr size_t csOffsetTaskId          = csOffsetFill + sizeof(uint8_t);
   static constexpr size_t csOffsetMessageSequence = csOffsetTaskId + sizeof(TaskId);
   static constexpr size_t csOffsetType            = csOffsetMessageSequence + sizeof(MessageSequence);
+  static constexpr size_t csOffsetTopic           = csOffsetType + sizeof(Type);
   
+  static_assert(static_cast<uint8_t>(Type::cStoredChars) <= csTypeMask);
+  static_assert(MessageBase<tPayloadSize, tSupportFloatingPoint>::csGroupSlotCount <= (std::numeric_limits<uint8_t>::max() >> csGroupSlotShift) + 1u);
+
   uint8_t mData[csTotalSize];
 
 public:
@@ -40,17 +52,22 @@ public:
 
   void setShutdown(TaskId const aTaskId) noexcept {
     mData[csOffsetType] = static_cast<uint8_t>(Type::cShutdown);
-    mData[csOffsetTaskId] = aTaskId;
+    std::memcpy(mData + csOffsetTaskId, &aTaskId, sizeof(aTaskId));
   }
 
   template<typename tArgument>
-  void set(tArgument const aValue, LogFormat const aFormat, TaskId const aTaskId, MessageSequence const aMessageSequence) noexcept {
+  void set(tArgument const aValue, LogFormat const aFormat, TaskId const aTaskId, MessageSequence const aMessageSequence, LogTopic const aTopic, GroupSlot const aGroupSlot) noexcept {
     std::memcpy(mData + csOffsetPayload, &aValue, sizeof(aValue));
     Type type = getType(aValue);
-    mData[csOffsetType] = static_cast<uint8_t>(type);
+    mData[csOffsetType] = static_cast<uint8_t>(type) | static_cast<uint8_t>(aGroupSlot << csGroupSlotShift);
     mData[csOffsetFill] = aFormat.mFill;
-    mData[csOffsetTaskId] = aTaskId;
-    mData[csOffsetMessageSequence] = aMessageSequence;
+    std::memcpy(mData + csOffsetTaskId, &aTaskId, sizeof(aTaskId));
+    std::memcpy(mData + csOffsetMessageSequence, &aMessageSequence, sizeof(aMessageSequence));
+    if constexpr(tStoreTopic) {
+      mData[csOffsetTopic] = static_cast<uint8_t>(aTopic);
+    }
+    else { // nothing to do
+    }
     if(type != Type::cStoredChars) {
       mData[csOffsetBase] = aFormat.mBase;
     }
@@ -60,8 +77,8 @@ public:
 
   template<typename tConverter>
   void output(tConverter& aConverter) const noexcept {
-    Type type = static_cast<Type>(mData[csOffsetType]);
-    uint8_t base = mData[csOffsetBase];
+    Type type = getStoredType();
+    uint8_t base = mData[csOffsetBase] & static_cast<uint8_t>(~LogFormat::csHeaderTickFlag);
     uint8_t fill = mData[csOffsetFill];
 
     if(type == Type::cBool) {
@@ -164,30 +181,65 @@ public:
   }
 
   bool isShutdown() const noexcept {
-    return static_cast<Type>(mData[csOffsetType]) == Type::cShutdown;
+    return getStoredType() == Type::cShutdown;
   }
 
   bool isTerminal() const noexcept {
-    return mData[csOffsetMessageSequence] == csTerminal;
+    return getMessageSequence() == csTerminal;
   }
 
   uint8_t getBase() const noexcept {
-    return mData[csOffsetBase];
+    return mData[csOffsetBase] & static_cast<uint8_t>(~LogFormat::csHeaderTickFlag);
   }  
 
+  bool isHeaderTick() const noexcept {
+    return getStoredType() != Type::cStoredChars && (mData[csOffsetBase] & LogFormat::csHeaderTickFlag) != 0u;
+  }
+
   uint8_t getFill() const noexcept {
     return mData[csOffsetFill];
   }  
 
   TaskId getTaskId() const noexcept {
-    return mData[csOffsetTaskId];
+    TaskId result;
+    std::memcpy(&result, mData + csOffsetTaskId, sizeof(result));
+    return result;
   }  
 
   MessageSequence getMessageSequence() const noexcept {
-    return mData[csOffsetMessageSequence];
+    return getStoredSequence() & static_cast<MessageSequence>(~csGenerationFlag);
+  }  
+
+  bool getGeneration() const noexcept {
+    return (getStoredSequence() & csGenerationFlag) != 0u;
+  }  
+
+  LogTopic getTopic() const noexcept {
+    LogTopic result = csNoTopic;
+    if constexpr(tStoreTopic) {
+      result = static_cast<LogTopic>(mData[csOffsetTopic]);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }  
+
+  GroupSlot getGroupSlot() const noexcept {
+    return mData[csOffsetType] >> csGroupSlotShift;
   }  
 
 private:
+  MessageSequence getStoredSequence() const noexcept {
+    MessageSequence result;
+    std::memcpy(&result, mData + csOffsetMessageSequence, sizeof(result));
+    return result;
+  }
+
+  Type getStoredType() const noexcept {
+    return static_cast<Type>(mData[csOffsetType] & csTypeMask);
+  }
+
+
   template<typename tArgument> static Type getType(tArgument const) noexcept { return Type::cInvalid; }
   static Type getType(bool const) noexcept { return Type::cBool; }
   static Type getType(float const) noexcept { return Type::cFloat; }
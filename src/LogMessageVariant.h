@@ -17,6 +17,8 @@ class MessageVariant final : public MessageBase<tPayloadSize, tSupportFloatingPo
 public:
   static constexpr size_t csPayloadSize = tPayloadSize;
   static constexpr bool   csSupportFloatingPoint = tSupportFloatingPoint;
+  static constexpr bool   csStoresTopic = true;
+  static constexpr MessageSequence csGenerationFlag = MessageBase<tPayloadSize, tSupportFloatingPoint>::csGenerationFlag;
 
 private:
   static constexpr MessageSequence csTerminal     = MessageBase<tPayloadSize, tSupportFloatingPoint>::csTerminal;
@@ -39,6 +41,8 @@ private:
   LogFormat       mFormat;
   TaskId          mTaskId;
   MessageSequence mMessageSequence;
+  LogTopic        mTopic;
+  GroupSlot       mGroupSlot;
 
 public:
   MessageVariant() = default;
@@ -50,19 +54,22 @@ public:
   void setShutdown(TaskId const aTaskId) noexcept {
     mPayload = ShutdownMessageContent::csSomething;
     mTaskId = aTaskId;
+    mGroupSlot = 0u;
   }
 
   template<typename tArgument>
-  void set(tArgument const aValue, LogFormat const aFormat, TaskId const aTaskId, MessageSequence const aMessageSequence) noexcept {
+  void set(tArgument const aValue, LogFormat const aFormat, TaskId const aTaskId, MessageSequence const aMessageSequence, LogTopic const aTopic, GroupSlot const aGroupSlot) noexcept {
     mPayload = aValue;
     mFormat = aFormat;
     mTaskId = aTaskId;
     mMessageSequence = aMessageSequence;
+    mTopic = aTopic;
+    mGroupSlot = aGroupSlot;
   }
 
   template<typename tConverter>
   void output(tConverter& aConverter) const noexcept {
-    auto visitor = [this, &aConverter](const auto aObj) { aConverter.convert(aObj, mFormat.mBase, mFormat.mFill); };
+    auto visitor = [this, &aConverter](const auto aObj) { aConverter.convert(aObj, mFormat.getBase(), mFormat.mFill); };
     std::visit(visitor, mPayload);
   }
 
@@ -71,11 +78,15 @@ public:
   }
 
   bool isTerminal() const noexcept {
-    return mMessageSequence == csTerminal;
+    return getMessageSequence() == csTerminal;
+  }
+
+  bool isHeaderTick() const noexcept {
+    return mFormat.isHeaderTick();
   }
 
   uint8_t getBase() const noexcept {
-    return mFormat.mBase;
+    return mFormat.getBase();
   }  
 
   uint8_t getFill() const noexcept {
@@ -87,7 +98,19 @@ public:
   }  
 
   MessageSequence getMessageSequence() const noexcept {
-    return mMessageSequence;
+    return mMessageSequence & static_cast<MessageSequence>(~csGenerationFlag);
+  }  
+
+  bool getGeneration() const noexcept {
+    return (mMessageSequence & csGenerationFlag) != 0u;
+  }  
+
+  LogTopic getTopic() const noexcept {
+    return mTopic;
+  }  
+
+  GroupSlot getGroupSlot() const noexcept {
+    return mGroupSlot;
   }  
 };
 
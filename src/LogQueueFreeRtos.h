@@ -38,13 +38,23 @@ public:
     return xQueueIsQueueEmptyFromISR(sQueue) == pdTRUE;
   }
 
-  static void push(tMessage const &aMessage) noexcept {
-    xQueueSendFromISR(sQueue, &aMessage, nullptr); // Don't care about the result, pop logic will manage missing messages.
+  /// The pop logic will manage missing messages, the result is only for statistics and retries.
+  static bool push(tMessage const &aMessage) noexcept {
+    return xQueueSendFromISR(sQueue, &aMessage, nullptr) == pdTRUE;
+  }
+
+  static bool pushFromIsr(tMessage const &aMessage) noexcept {
+    return push(aMessage);
   }
 
   static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
     return xQueueReceive(sQueue, &aMessage, aPauseLength) == pdTRUE;
   }
+
+  /// Does not block, used to drain the queue in emergency.
+  static bool tryPop(tMessage &aMessage) noexcept {
+    return xQueueReceiveFromISR(sQueue, &aMessage, nullptr) == pdTRUE;
+  }
 };
 
 }
@@ -2,13 +2,16 @@
 #define LOG_QUEUE_STD_BOOST
 
 #include <cstddef>
+#include <array>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 #include <boost/lockfree/queue.hpp>
 
 namespace nowtech::log {
 
-template<typename tMessage, typename tAppInterface, size_t tQueueSize>
+/// tIsrQueueSize is the capacity of the separate queue for interrupt contexts (signal handlers).
+template<typename tMessage, typename tAppInterface, size_t tQueueSize, size_t tIsrQueueSize = 256u>
 class QueueStdBoost final {
 public:
   using tMessage_ = tMessage;
@@ -39,7 +42,7 @@ private:
       return mQueue.empty();
     }
 
-    void push(tMessage const &aMessage) noexcept {
+    bool push(tMessage const &aMessage) noexcept {
       bool success = mQueue.bounded_push(aMessage);
       if(success) {
         mNotified = true;
@@ -47,6 +50,7 @@ private:
       }
       else { // nothing to do
       }
+      return success;
     }
 
     bool pop(tMessage &aMessage, LogTime const mPauseLength) noexcept {
@@ -61,9 +65,91 @@ private:
       }
       return result;
     }
+
+    /// Lock-free, does not touch the condition variable.
+    bool tryPop(tMessage &aMessage) noexcept {
+      return mQueue.pop(aMessage);
+    }
+  };
+
+  /// Bounded multi-producer single-consumer ring for signal handlers, after
+  /// Dmitry Vyukov's bounded queue. Each slot carries the position it
+  /// expects to be written or read at next. Producers give up after a few
+  /// lost races instead of retrying forever, so pushing takes a bounded
+  /// number of steps without locks or allocation. There is no notification,
+  /// the transmitter finds these messages at latest after its refresh period.
+  class IsrQueue final {
+    static constexpr uint32_t csMaxPushAttempts = 8u;
+
+    struct Slot final {
+      std::atomic<uint64_t> mSequence;
+      tMessage              mMessage;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free);
+    static_assert(std::is_trivially_copyable_v<tMessage>);
+
+    std::array<Slot, tIsrQueueSize> mSlots;
+    std::atomic<uint64_t>           mHead;
+    uint64_t                        mTail;       // Only the consumer uses it.
+
+  public:
+    IsrQueue() noexcept
+      : mHead(0u)
+      , mTail(0u) {
+      for(uint64_t i = 0u; i < tIsrQueueSize; ++i) {
+        mSlots[i].mSequence.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    bool empty() const noexcept {
+      return mSlots[mTail % tIsrQueueSize].mSequence.load(std::memory_order_acquire) != mTail + 1u;
+    }
+
+    /// Drops the message if the ring is full or the producers keep colliding.
+    bool push(tMessage const &aMessage) noexcept {
+      bool result = false;
+      uint64_t position = mHead.load(std::memory_order_relaxed);
+      for(uint32_t attempt = 0u; attempt < csMaxPushAttempts; ++attempt) {
+        Slot &slot = mSlots[position % tIsrQueueSize];
+        uint64_t const sequence = slot.mSequence.load(std::memory_order_acquire);
+        if(sequence == position) {
+          if(mHead.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+            slot.mMessage = aMessage;
+            slot.mSequence.store(position + 1u, std::memory_order_release);
+            result = true;
+            break;
+          }
+          else { // position was reloaded, try again
+          }
+        }
+        else if(sequence < position) {   // Full.
+          break;
+        }
+        else {
+          position = mHead.load(std::memory_order_relaxed);
+        }
+      }
+      return result;
+    }
+
+    bool pop(tMessage &aMessage) noexcept {
+      bool result = false;
+      Slot &slot = mSlots[mTail % tIsrQueueSize];
+      if(slot.mSequence.load(std::memory_order_acquire) == mTail + 1u) {
+        aMessage = slot.mMessage;
+        slot.mSequence.store(mTail + tIsrQueueSize, std::memory_order_release);
+        ++mTail;
+        result = true;
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
   };
 
   inline static FreeRtosQueue sQueue;
+  inline static IsrQueue      sIsrQueue;
 
   QueueStdBoost() = delete;
 
@@ -75,15 +161,26 @@ public:
   }
 
   static bool empty() noexcept {
-    return sQueue.empty();
+    return sQueue.empty() && sIsrQueue.empty();
   }
 
-  static void push(tMessage const &aMessage) noexcept {
-    sQueue.push(aMessage);
+  /// Returns false if the queue was full and the message got dropped.
+  static bool push(tMessage const &aMessage) noexcept {
+    return sQueue.push(aMessage);
+  }
+
+  /// Async-signal-safe, wait-free apart from the bounded retries of colliding producers.
+  static bool pushFromIsr(tMessage const &aMessage) noexcept {
+    return sIsrQueue.push(aMessage);
   }
 
   static bool pop(tMessage &aMessage, LogTime const aPauseLength) noexcept {
-    return sQueue.pop(aMessage, aPauseLength);
+    return sIsrQueue.pop(aMessage) || sQueue.pop(aMessage, aPauseLength);
+  }
+
+  /// Does not block, used to drain the queue in emergency.
+  static bool tryPop(tMessage &aMessage) noexcept {
+    return sIsrQueue.pop(aMessage) || sQueue.tryPop(aMessage);
   }
 };
 
@@ -26,12 +26,21 @@ public:
     return true;
   }
 
-  static void push(tMessage const) noexcept { // nothing to do
+  static bool push(tMessage const) noexcept { // nothing to do
+    return true;
+  }
+
+  static bool pushFromIsr(tMessage const) noexcept { // nothing to do
+    return true;
   }
 
   static bool pop(tMessage &, LogTime const) noexcept { // nothing to do
     return false;
   }
+
+  static bool tryPop(tMessage &) noexcept { // nothing to do
+    return false;
+  }
 };
 
 }
@@ -0,0 +1,178 @@
+#ifndef NOWTECH_LOG_RATE_LIMIT
+#define NOWTECH_LOG_RATE_LIMIT
+
+#include "LogMessageBase.h"
+#include <atomic>
+#include <limits>
+#include <cstdint>
+
+namespace nowtech::log {
+
+/// Limits the lines passing through it to mCount per mPeriod (in LogTime
+/// units), allowing bursts of mCount, and optionally lets only every
+/// mSampleInterval-th line through. Log keeps one for each topic, and
+/// call sites may have their own as a static local object. The token bucket
+/// is implemented as the generic cell rate algorithm: a single atomic holds
+/// the theoretical arrival time of the next line, scaled by mCount to stay
+/// in integers, so checking takes one load and one compare-exchange.
+/// Suppressed lines are counted, and Log reports them before the next line
+/// getting through, at most once in LogConfig::suppressionReportPeriod.
+/// On the first suppression Log links the limit into a list, so that its
+/// transmitter reports the pending counts when idle, too. So a limit must
+/// live as long as Log uses it, which static objects do.
+template<typename tAppInterface>
+class RateLimit final {
+public:
+  using LogTime = typename tAppInterface::LogTime;
+
+private:
+  std::atomic<uint64_t> mTheoreticalArrival;  // Scaled by mCount.
+  std::atomic<uint32_t> mSampleCounter;
+  std::atomic<uint32_t> mSuppressedCount;
+  std::atomic<uint32_t> mCount;               // 0 means no rate limit.
+  std::atomic<LogTime>  mPeriod;
+  std::atomic<uint32_t> mSampleInterval;      // 1 means no sampling.
+  std::atomic<LogTime>  mLastReport;
+  std::atomic<LogTopic> mTopic;               // Of the last suppressed line.
+  std::atomic<bool>     mListed;
+  RateLimit            *mNextListed;          // Written once before publishing.
+
+public:
+  RateLimit() noexcept
+  : RateLimit(0u, 0u, 1u) {
+  }
+
+  RateLimit(uint32_t const aCount, LogTime const aPeriod, uint32_t const aSampleInterval = 1u) noexcept
+  : mTheoreticalArrival(0u)
+  , mSampleCounter(0u)
+  , mSuppressedCount(0u)
+  , mCount(aCount)
+  , mPeriod(aPeriod)
+  , mSampleInterval(aSampleInterval == 0u ? 1u : aSampleInterval)
+  , mLastReport(0u)
+  , mTopic(std::numeric_limits<LogTopic>::min())
+  , mListed(false)
+  , mNextListed(nullptr) {
+  }
+
+  RateLimit(RateLimit const &) = delete;
+  RateLimit& operator=(RateLimit const &) = delete;
+
+  /// aCount == 0 removes the limit.
+  void setRate(uint32_t const aCount, LogTime const aPeriod) noexcept {
+    mCount.store(aCount, std::memory_order_relaxed);
+    mPeriod.store(aPeriod, std::memory_order_relaxed);
+    mTheoreticalArrival.store(0u, std::memory_order_relaxed);
+  }
+
+  /// aInterval <= 1 removes sampling.
+  void setSampling(uint32_t const aInterval) noexcept {
+    mSampleInterval.store(aInterval == 0u ? 1u : aInterval, std::memory_order_relaxed);
+  }
+
+  void clear() noexcept {
+    setRate(0u, 0u);
+    setSampling(1u);
+    mSuppressedCount.store(0u, std::memory_order_relaxed);
+    mLastReport.store(0u, std::memory_order_relaxed);
+  }
+
+  /// Returns true if the line may be logged. Without limits it costs two relaxed loads.
+  bool admit() noexcept {
+    bool result = true;
+    uint32_t const interval = mSampleInterval.load(std::memory_order_relaxed);
+    if(interval > 1u && mSampleCounter.fetch_add(1u, std::memory_order_relaxed) % interval != 0u) {
+      result = false;
+    }
+    else { // nothing to do
+    }
+    uint32_t const count = mCount.load(std::memory_order_relaxed);
+    if(result && count > 0u) {
+      result = take(count, mPeriod.load(std::memory_order_relaxed));
+    }
+    else { // nothing to do
+    }
+    if(!result) {
+      mSuppressedCount.fetch_add(1u, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Returns the lines suppressed since the last report if aReportPeriod
+  /// has elapsed since then, otherwise 0. Only one of the concurrent callers
+  /// gets them. Costs one relaxed load if nothing was suppressed.
+  uint32_t takeSuppressedCount(LogTime const aReportPeriod) noexcept {
+    uint32_t result = 0u;
+    if(mSuppressedCount.load(std::memory_order_relaxed) > 0u) {
+      LogTime const now = tAppInterface::getLogTime();
+      LogTime last = mLastReport.load(std::memory_order_relaxed);
+      if(static_cast<LogTime>(now - last) >= aReportPeriod && mLastReport.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+        result = mSuppressedCount.exchange(0u, std::memory_order_relaxed);
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Called by Log for a suppressed line. Returns true only for the first
+  /// call, when Log has to link the limit into its list.
+  bool noteSuppression(LogTopic const aTopic) noexcept {
+    if(mTopic.load(std::memory_order_relaxed) != aTopic) {
+      mTopic.store(aTopic, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+    return !mListed.load(std::memory_order_relaxed) && !mListed.exchange(true, std::memory_order_relaxed);
+  }
+
+  LogTopic getTopic() const noexcept {
+    return mTopic.load(std::memory_order_relaxed);
+  }
+
+  void setNextListed(RateLimit * const aNext) noexcept {
+    mNextListed = aNext;
+  }
+
+  RateLimit *getNextListed() const noexcept {
+    return mNextListed;
+  }
+
+private:
+  bool take(uint32_t const aCount, LogTime const aPeriod) noexcept {
+    uint64_t const now = static_cast<uint64_t>(tAppInterface::getLogTime()) * aCount;
+    uint64_t const limit = static_cast<uint64_t>(aPeriod) * aCount;
+    // An other thread may have taken a token with a later now, so only a huge difference means wrapping.
+    uint64_t const wrapLimit = static_cast<uint64_t>(std::numeric_limits<LogTime>::max() / 2u) * aCount;
+    uint64_t arrival = mTheoreticalArrival.load(std::memory_order_relaxed);
+    bool result = false;
+    while(true) {
+      uint64_t base;
+      if(arrival > now + wrapLimit) {   // LogTime wrapped around, start over.
+        base = now;
+      }
+      else {
+        base = arrival > now ? arrival : now;
+      }
+      uint64_t const next = base + aPeriod;
+      if(next - now > limit) {
+        break;
+      }
+      else if(mTheoreticalArrival.compare_exchange_weak(arrival, next, std::memory_order_relaxed)) {
+        result = true;
+        break;
+      }
+      else { // arrival was reloaded, try again
+      }
+    }
+    return result;
+  }
+};
+
+}
+
+#endif
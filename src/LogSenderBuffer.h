@@ -0,0 +1,102 @@
+#ifndef NOWTECH_LOG_SENDER_BUFFER
+#define NOWTECH_LOG_SENDER_BUFFER
+
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+namespace nowtech::log {
+
+/// The buffer of the senders collecting several groups to pass them on in
+/// large chunks. The converter works directly in it through getBuffer(), so
+/// in queued mode collecting costs no extra copy. The sender passes its own
+/// flush function to send(), which takes the content between getBegin() and
+/// getPosition(), and then calls clear(), or reset() to continue in an other
+/// buffer. Flushing happens when there is no room for another
+/// tTransmitBufferSize chunk, or the oldest content is older than tTimeout.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, typename tAppInterface::LogTime tTimeout>
+class SenderBuffer final {
+public:
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+  using LogTime          = typename tAppInterface::LogTime;
+
+private:
+  Iterator mBegin;
+  Iterator mEnd;
+  Iterator mPosition;
+  LogTime  mFirstPendingTime;
+
+public:
+  void reset(Iterator const aBegin, Iterator const aEnd) noexcept {
+    mBegin = aBegin;
+    mEnd = aEnd;
+    mPosition = aBegin;
+  }
+
+  void clear() noexcept {
+    mPosition = mBegin;
+  }
+
+  Iterator getBegin() const noexcept {
+    return mBegin;
+  }
+
+  Iterator getPosition() const noexcept {
+    return mPosition;
+  }
+
+  size_t getLength() const noexcept {
+    return mPosition - mBegin;
+  }
+
+  bool isEmpty() const noexcept {
+    return mPosition == mBegin;
+  }
+
+  auto getBuffer() const noexcept {
+    return std::pair(mPosition, mPosition + tTransmitBufferSize);
+  }
+
+  /// If aBegin is the one returned by getBuffer(), the converted data is already in place.
+  template<typename tFlush>
+  void send(ConversionResult const * const aBegin, ConversionResult const * const aEnd, tFlush const aFlush) {
+    if(mPosition == mBegin) {
+      mFirstPendingTime = tAppInterface::getLogTime();
+    }
+    else { // nothing to do
+    }
+    if(aBegin == mPosition) {
+      mPosition += aEnd - aBegin;
+    }
+    else {
+      append(aBegin, aEnd, aFlush);
+    }
+    if(static_cast<size_t>(mEnd - mPosition) < tTransmitBufferSize || tAppInterface::getLogTime() - mFirstPendingTime >= tTimeout) {
+      aFlush();
+    }
+    else { // nothing to do
+    }
+  }
+
+private:
+  /// aFlush may switch to an other buffer, so the bounds are read again after it.
+  template<typename tFlush>
+  void append(ConversionResult const * const aBegin, ConversionResult const * const aEnd, tFlush const aFlush) {
+    ConversionResult const * where = aBegin;
+    while(where < aEnd) {
+      if(mPosition == mEnd) {
+        aFlush();
+      }
+      else { // nothing to do
+      }
+      size_t const chunk = std::min<size_t>(aEnd - where, mEnd - mPosition);
+      mPosition = std::copy_n(where, chunk, mPosition);
+      where += chunk;
+    }
+  }
+};
+
+}
+
+#endif
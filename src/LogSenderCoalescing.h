@@ -0,0 +1,76 @@
+#ifndef NOWTECH_LOG_SENDER_COALESCING
+#define NOWTECH_LOG_SENDER_COALESCING
+
+#include "Log.h"
+#include "LogSenderBuffer.h"
+#include <utility>
+
+namespace nowtech::log {
+
+/// Wraps an other sender and collects the converted groups in a large buffer
+/// to hand them over in one send() call. The converter works directly in the
+/// buffer, so coalescing costs no extra copy in queued mode. The buffer is
+/// passed on when it has no room for another tTransmitBufferSize chunk, when
+/// its oldest content is older than tTimeout, or on flush(), which Log calls
+/// when its queue runs empty at most once in tRefreshPeriod, or stays idle
+/// for tRefreshPeriod. init() and
+/// done() initialize and shut down the wrapped sender as well, but its
+/// getBuffer() is not used.
+template<typename tSender, size_t tTransmitBufferSize, size_t tCoalesceBufferSize, typename tSender::tAppInterface_::LogTime tTimeout>
+class SenderCoalescing final {
+public:
+  using tAppInterface_   = typename tSender::tAppInterface_;
+  using tConverter_      = typename tSender::tConverter_;
+  using ConversionResult = typename tConverter_::ConversionResult;
+  using Iterator         = typename tConverter_::Iterator;
+  using LogTime          = typename tAppInterface_::LogTime;
+
+  static constexpr bool csVoid = tSender::csVoid;
+
+private:
+  using SendBuffer = SenderBuffer<tAppInterface_, tConverter_, tTransmitBufferSize, tTimeout>;
+
+  static_assert(tCoalesceBufferSize >= tTransmitBufferSize);
+
+  inline static ConversionResult *sStorage;
+  inline static SendBuffer        sSendBuffer;
+
+  SenderCoalescing() = delete;
+
+public:
+  /// aArgs are passed to the init() of the wrapped sender.
+  template<typename ...tArgs>
+  static void init(tArgs&&... aArgs) {
+    tSender::init(std::forward<tArgs>(aArgs)...);
+    sStorage = tAppInterface_::template _newArray<ConversionResult>(tCoalesceBufferSize);
+    sSendBuffer.reset(sStorage, sStorage + tCoalesceBufferSize);
+  }
+
+  static void done() {
+    flush();
+    tSender::done();
+    tAppInterface_::template _deleteArray<ConversionResult>(sStorage);
+  }
+
+  static void send(ConversionResult const * const aBegin, ConversionResult const * const aEnd) {
+    sSendBuffer.send(aBegin, aEnd, flush);
+  }
+
+  static auto getBuffer() {
+    return sSendBuffer.getBuffer();
+  }
+
+  static void flush() {
+    if(!sSendBuffer.isEmpty()) {
+      tSender::send(sSendBuffer.getBegin(), sSendBuffer.getPosition());
+      sSendBuffer.clear();
+    }
+    else { // nothing to do
+    }
+    tSender::flush();
+  }
+};
+
+}
+
+#endif
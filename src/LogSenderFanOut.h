@@ -0,0 +1,282 @@
+#ifndef NOWTECH_LOG_SENDER_FAN_OUT
+#define NOWTECH_LOG_SENDER_FAN_OUT
+
+#include "Log.h"
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <limits>
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <algorithm>
+#include <condition_variable>
+
+namespace nowtech::log {
+
+/// Delivers each converted group to several senders (sinks), each having its
+/// own ring buffer of tSinkBufferSize and a worker thread calling the sink.
+/// The transmitter only copies the group into the rings, so a slow or stuck
+/// sink never delays the others or the logging tasks: if a ring has no room
+/// for the whole group, the group is dropped for that sink only and counted.
+/// Each sink can be restricted to some topics with setTopicEnabled(). Groups
+/// logged without a topic are routed by setUntopicedEnabled(). All sinks are
+/// enabled for everything after init(). Each send() call becomes a record in
+/// the rings, and the sinks receive it in a single send() call, even if it
+/// wraps around the ring end, so datagram sinks get whole records. The sinks
+/// are owned by the application: it calls their init() before init() here and
+/// their done() after done() here. Their getBuffer() is not used.
+template<size_t tTransmitBufferSize, size_t tSinkBufferSize, typename tFirstSender, typename ... tOtherSenders>
+class SenderFanOut final {
+public:
+  using tAppInterface_   = typename tFirstSender::tAppInterface_;
+  using tConverter_      = typename tFirstSender::tConverter_;
+  using ConversionResult = typename tConverter_::ConversionResult;
+  using Iterator         = typename tConverter_::Iterator;
+
+  static constexpr bool   csVoid      = false;
+  static constexpr size_t csSinkCount = 1u + sizeof...(tOtherSenders);
+
+private:
+  static_assert(sizeof(LogTopic) == 1u);
+  static_assert(tTransmitBufferSize <= std::numeric_limits<uint32_t>::max());
+
+  using RecordLength = uint32_t;
+  static constexpr size_t csRecordHeaderSize = (sizeof(RecordLength) + sizeof(ConversionResult) - 1u) / sizeof(ConversionResult);
+  static_assert(tSinkBufferSize >= tTransmitBufferSize + csRecordHeaderSize);
+
+  static constexpr uint32_t csTopicWordBits  = 64u;
+  static constexpr uint32_t csTopicWordCount = 2u;   // LogTopic is int8_t, csInvalidTopic is its minimum.
+  static constexpr LogTopic csInvalidTopic   = TopicInstance::csInvalidTopic;
+
+  using Senders = std::tuple<tFirstSender, tOtherSenders...>;
+
+  /// The transmitter is the only producer, the worker the only consumer.
+  /// Offsets count all bytes ever written or read, and are guarded by mMutex.
+  /// Records are stored as their length followed by the content. mLinear
+  /// holds a record wrapping around the ring end.
+  struct Sink final {
+    ConversionResult        *mRing;
+    ConversionResult        *mLinear;
+    uint64_t                 mWriteOffset;
+    uint64_t                 mReadOffset;
+    std::atomic<uint64_t>    mTopicMask[csTopicWordCount];
+    std::atomic<bool>        mUntopicedEnabled;
+    std::atomic<uint64_t>    mDroppedCount;
+    std::thread             *mWorker;
+    std::mutex               mMutex;
+    std::condition_variable  mConditionVariable;
+    bool                     mKeepAlive;
+  };
+
+  inline static Sink             *sSinks;
+  inline static ConversionResult *sTransmitBuffer;
+
+  SenderFanOut() = delete;
+
+public:
+  static void init() {
+    sTransmitBuffer = tAppInterface_::template _newArray<ConversionResult>(tTransmitBufferSize);
+    sSinks = tAppInterface_::template _newArray<Sink>(csSinkCount);
+    for(size_t i = 0u; i < csSinkCount; ++i) {
+      Sink &sink = sSinks[i];
+      sink.mRing = tAppInterface_::template _newArray<ConversionResult>(tSinkBufferSize);
+      sink.mLinear = tAppInterface_::template _newArray<ConversionResult>(tTransmitBufferSize);
+      sink.mWriteOffset = 0u;
+      sink.mReadOffset = 0u;
+      for(auto &word : sink.mTopicMask) {
+        word = ~static_cast<uint64_t>(0u);
+      }
+      sink.mUntopicedEnabled = true;
+      sink.mDroppedCount = 0u;
+      sink.mKeepAlive = true;
+    }
+    startWorkers(std::make_index_sequence<csSinkCount>{});
+  }
+
+  /// Lets the workers send everything already in the rings. The sinks are
+  /// still usable afterwards, the application calls their done().
+  static void done() {
+    for(size_t i = 0u; i < csSinkCount; ++i) {
+      Sink &sink = sSinks[i];
+      {
+        std::lock_guard<std::mutex> lock(sink.mMutex);
+        sink.mKeepAlive = false;
+      }
+      sink.mConditionVariable.notify_all();
+      sink.mWorker->join();
+      delete sink.mWorker;
+      tAppInterface_::template _deleteArray<ConversionResult>(sink.mLinear);
+      tAppInterface_::template _deleteArray<ConversionResult>(sink.mRing);
+    }
+    tAppInterface_::template _deleteArray<Sink>(sSinks);
+    tAppInterface_::template _deleteArray<ConversionResult>(sTransmitBuffer);
+  }
+
+  static void send(ConversionResult const * const aBegin, ConversionResult const * const aEnd) {
+    send(aBegin, aEnd, csInvalidTopic);
+  }
+
+  /// Called by Log with the topic of the group, or csInvalidTopic for untopiced ones.
+  static void send(ConversionResult const * const aBegin, ConversionResult const * const aEnd, LogTopic const aTopic) {
+    RecordLength const length = static_cast<RecordLength>(aEnd - aBegin);
+    ConversionResult header[csRecordHeaderSize];
+    std::memcpy(header, &length, sizeof(length));
+    for(size_t i = 0u; i < csSinkCount; ++i) {
+      Sink &sink = sSinks[i];
+      if(length > 0u && isEnabled(sink, aTopic)) {
+        std::unique_lock<std::mutex> lock(sink.mMutex);
+        if(length <= tTransmitBufferSize && tSinkBufferSize - (sink.mWriteOffset - sink.mReadOffset) >= csRecordHeaderSize + length) {
+          copyToRing(sink, header, csRecordHeaderSize);
+          copyToRing(sink, aBegin, length);
+          lock.unlock();
+          sink.mConditionVariable.notify_one();
+        }
+        else {
+          ++sink.mDroppedCount;
+        }
+      }
+      else { // nothing to do
+      }
+    }
+  }
+
+  static auto getBuffer() {
+    return std::pair(sTransmitBuffer, sTransmitBuffer + tTransmitBufferSize);
+  }
+
+  /// The workers send all they have, so nothing to do here.
+  static void flush() noexcept {
+  }
+
+  /// May be called any time after init() from any thread.
+  static void setTopicEnabled(size_t const aSinkIndex, LogTopic const aTopic, bool const aEnabled) noexcept {
+    if(aSinkIndex < csSinkCount && aTopic != csInvalidTopic) {
+      uint32_t const index = static_cast<uint8_t>(aTopic);
+      uint64_t const bit = static_cast<uint64_t>(1u) << (index % csTopicWordBits);
+      std::atomic<uint64_t> &word = sSinks[aSinkIndex].mTopicMask[index / csTopicWordBits];
+      if(aEnabled) {
+        word.fetch_or(bit, std::memory_order_relaxed);
+      }
+      else {
+        word.fetch_and(~bit, std::memory_order_relaxed);
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Enables or disables all topics for the sink, apart from untopiced groups.
+  static void setAllTopicsEnabled(size_t const aSinkIndex, bool const aEnabled) noexcept {
+    if(aSinkIndex < csSinkCount) {
+      for(auto &word : sSinks[aSinkIndex].mTopicMask) {
+        word.store(aEnabled ? ~static_cast<uint64_t>(0u) : 0u, std::memory_order_relaxed);
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void setUntopicedEnabled(size_t const aSinkIndex, bool const aEnabled) noexcept {
+    if(aSinkIndex < csSinkCount) {
+      sSinks[aSinkIndex].mUntopicedEnabled.store(aEnabled, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Number of groups dropped so far for the sink because its ring was full.
+  static uint64_t getDroppedCount(size_t const aSinkIndex) noexcept {
+    return aSinkIndex < csSinkCount ? sSinks[aSinkIndex].mDroppedCount.load(std::memory_order_relaxed) : 0u;
+  }
+
+  /// Sum for all sinks, which Log::getStatistics() reports.
+  static uint64_t getDroppedCount() noexcept {
+    uint64_t result = 0u;
+    for(size_t i = 0u; i < csSinkCount; ++i) {
+      result += getDroppedCount(i);
+    }
+    return result;
+  }
+
+private:
+  static bool isEnabled(Sink const &aSink, LogTopic const aTopic) noexcept {
+    bool result;
+    if(aTopic == csInvalidTopic) {
+      result = aSink.mUntopicedEnabled.load(std::memory_order_relaxed);
+    }
+    else {
+      uint32_t const index = static_cast<uint8_t>(aTopic);
+      result = (aSink.mTopicMask[index / csTopicWordBits].load(std::memory_order_relaxed) & (static_cast<uint64_t>(1u) << (index % csTopicWordBits))) != 0u;
+    }
+    return result;
+  }
+
+  template<size_t ... tIndices>
+  static void startWorkers(std::index_sequence<tIndices...>) {
+    ((sSinks[tIndices].mWorker = new std::thread(workerFunction<tIndices>)), ...);
+  }
+
+  /// Called by the transmitter holding the lock, after checking for room.
+  static void copyToRing(Sink &aSink, ConversionResult const * const aSource, size_t const aLength) noexcept {
+    size_t const position = aSink.mWriteOffset % tSinkBufferSize;
+    size_t const first = std::min(aLength, tSinkBufferSize - position);
+    std::copy_n(aSource, first, aSink.mRing + position);
+    std::copy_n(aSource + first, aLength - first, aSink.mRing);
+    aSink.mWriteOffset += aLength;
+  }
+
+  /// Called by the worker, the transmitter does not touch the data behind mWriteOffset.
+  static void copyFromRing(Sink const &aSink, uint64_t const aOffset, ConversionResult * const aDestination, size_t const aLength) noexcept {
+    size_t const position = aOffset % tSinkBufferSize;
+    size_t const first = std::min(aLength, tSinkBufferSize - position);
+    std::copy_n(aSink.mRing + position, first, aDestination);
+    std::copy_n(aSink.mRing, aLength - first, aDestination + first);
+  }
+
+  /// Sends one record at a time without holding the lock. A record wrapping
+  /// around the ring end is copied to mLinear first.
+  template<size_t tIndex>
+  static void workerFunction() noexcept {
+    using Sender = std::tuple_element_t<tIndex, Senders>;
+    Sink &sink = sSinks[tIndex];
+    std::unique_lock<std::mutex> lock(sink.mMutex);
+    while(true) {
+      sink.mConditionVariable.wait(lock, [&sink]{ return sink.mWriteOffset != sink.mReadOffset || !sink.mKeepAlive; });
+      if(sink.mWriteOffset == sink.mReadOffset) {
+        break;
+      }
+      else { // nothing to do
+      }
+      uint64_t const readOffset = sink.mReadOffset;
+      ConversionResult header[csRecordHeaderSize];
+      copyFromRing(sink, readOffset, header, csRecordHeaderSize);
+      RecordLength length;
+      std::memcpy(&length, header, sizeof(length));
+      uint64_t const contentOffset = readOffset + csRecordHeaderSize;
+      size_t const position = contentOffset % tSinkBufferSize;
+      bool const drained = contentOffset + length == sink.mWriteOffset;
+      lock.unlock();
+      ConversionResult const *begin;
+      if(position + length <= tSinkBufferSize) {
+        begin = sink.mRing + position;
+      }
+      else {
+        copyFromRing(sink, contentOffset, sink.mLinear, length);
+        begin = sink.mLinear;
+      }
+      Sender::send(begin, begin + length);
+      if(drained) {
+        Sender::flush();
+      }
+      else { // nothing to do
+      }
+      lock.lock();
+      sink.mReadOffset = contentOffset + length;
+    }
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,199 @@
+#ifndef NOWTECH_LOG_SENDER_FILE
+#define NOWTECH_LOG_SENDER_FILE
+
+#include "Log.h"
+#include "LogSenderBuffer.h"
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace nowtech::log {
+
+struct SenderFileConfig final {
+public:
+  /// Path of the active log file. Rotated files get the suffixes .1, .2 ...
+  /// where .1 is the most recent one. Must outlive the sender.
+  char const *fileName       = nullptr;
+
+  /// The active file is rotated before it would exceed this size in bytes.
+  /// 0 disables size-based rotation.
+  size_t      rotationSize   = 0u;
+
+  /// The active file is rotated when it is older than this, in ms.
+  /// 0 disables time-based rotation.
+  uint32_t    rotationPeriod = 0u;
+
+  /// Number of rotated files to keep. When 0, rotation simply restarts the active file.
+  uint8_t     keepCount      = 4u;
+
+  /// fdatasync is called on write if the previous one happened at least this long ago, in ms.
+  /// 0 disables periodic syncing, but rotation and done() always sync.
+  uint32_t    syncPeriod     = 0u;
+
+  SenderFileConfig() noexcept = default;
+};
+
+/// Writes to a file using raw descriptor calls, bypassing iostreams. The
+/// converter works directly in a large write buffer, so several groups are
+/// written with one syscall. tTimeout is the longest time in ms buffered data
+/// may wait while new groups keep arriving. Log calls flush() when its queue
+/// runs empty, at most once in its tRefreshPeriod, or stays idle. All file operations including rotation happen
+/// on the thread calling send(), which is the transmitter thread in queued mode.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, typename tAppInterface::LogTime tTimeout, size_t tWriteBufferSize>
+class SenderFile final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+  using LogTime          = typename tAppInterface::LogTime;
+
+  static constexpr bool csVoid = false;
+
+private:
+  using SendBuffer = SenderBuffer<tAppInterface, tConverter, tTransmitBufferSize, tTimeout>;
+
+  static_assert(std::is_same_v<ConversionResult, char>);
+  static_assert(tWriteBufferSize >= tTransmitBufferSize);
+
+  static constexpr int    csInvalidFd          = -1;
+  static constexpr int    csOpenFlags          = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+  static constexpr mode_t csOpenMode           = 0644;
+  static constexpr size_t csMaxSuffixLength    = 5u;   // .255 and terminal 0
+
+  inline static constexpr char csSuffixFormat[] = "%s.%u";
+
+  inline static SenderFileConfig const *sConfig;
+  inline static int               sFd = csInvalidFd;
+  inline static char             *sRotatedName;
+  inline static char             *sRotatedNameOther;
+  inline static size_t            sRotatedNameSize;
+  inline static ConversionResult *sWriteBuffer;
+  inline static SendBuffer        sSendBuffer;
+  inline static size_t            sFileSize;
+  inline static LogTime           sOpenTime;
+  inline static LogTime           sLastSyncTime;
+
+  SenderFile() = delete;
+
+public:
+  static void init(SenderFileConfig const &aConfig) {
+    sConfig = &aConfig;
+    sRotatedNameSize = std::strlen(aConfig.fileName) + csMaxSuffixLength;
+    sRotatedName = tAppInterface::template _newArray<char>(sRotatedNameSize);
+    sRotatedNameOther = tAppInterface::template _newArray<char>(sRotatedNameSize);
+    sWriteBuffer = tAppInterface::template _newArray<ConversionResult>(tWriteBufferSize);
+    sSendBuffer.reset(sWriteBuffer, sWriteBuffer + tWriteBufferSize);
+    sLastSyncTime = tAppInterface::getLogTime();
+    open();
+  }
+
+  static void done() noexcept {
+    flush();
+    if(sFd != csInvalidFd) {
+      ::fdatasync(sFd);
+      ::close(sFd);
+      sFd = csInvalidFd;
+    }
+    else { // nothing to do
+    }
+    tAppInterface::template _deleteArray<ConversionResult>(sWriteBuffer);
+    tAppInterface::template _deleteArray<char>(sRotatedNameOther);
+    tAppInterface::template _deleteArray<char>(sRotatedName);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) {
+    sSendBuffer.send(aBegin, aEnd, flush);
+  }
+
+  static auto getBuffer() {
+    return sSendBuffer.getBuffer();
+  }
+
+  /// Writes out the buffer content, rotating the file before if needed.
+  static void flush() {
+    if(!sSendBuffer.isEmpty()) {
+      size_t const length = sSendBuffer.getLength();
+      if(isRotationDue(length)) {
+        rotate();
+      }
+      else { // nothing to do
+      }
+      write(sSendBuffer.getBegin(), length);
+      sSendBuffer.clear();
+      sFileSize += length;
+      LogTime const now = tAppInterface::getLogTime();
+      if(sConfig->syncPeriod > 0u && now - sLastSyncTime >= sConfig->syncPeriod) {
+        ::fdatasync(sFd);
+        sLastSyncTime = now;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+private:
+  static bool isRotationDue(size_t const aLength) noexcept {
+    return (sConfig->rotationSize > 0u && sFileSize > 0u && sFileSize + aLength > sConfig->rotationSize)
+        || (sConfig->rotationPeriod > 0u && tAppInterface::getLogTime() - sOpenTime >= sConfig->rotationPeriod);
+  }
+
+  static void open() {
+    sFd = ::open(sConfig->fileName, csOpenFlags, csOpenMode);
+    struct stat status;
+    if(sFd != csInvalidFd && ::fstat(sFd, &status) == 0) {
+      sFileSize = status.st_size;
+      sOpenTime = tAppInterface::getLogTime();
+    }
+    else {
+      tAppInterface::error(Exception::cSenderError);
+    }
+  }
+
+  /// Renames name.(n-1) to name.n ... name to name.1, so the oldest one gets overwritten.
+  static void rotate() {
+    ::fdatasync(sFd);
+    ::close(sFd);
+    if(sConfig->keepCount > 0u) {
+      for(unsigned index = sConfig->keepCount; index > 1u; --index) {
+        std::snprintf(sRotatedName, sRotatedNameSize, csSuffixFormat, sConfig->fileName, index);
+        std::snprintf(sRotatedNameOther, sRotatedNameSize, csSuffixFormat, sConfig->fileName, index - 1u);
+        ::rename(sRotatedNameOther, sRotatedName);   // Missing ones are not an error.
+      }
+      std::snprintf(sRotatedName, sRotatedNameSize, csSuffixFormat, sConfig->fileName, 1u);
+      ::rename(sConfig->fileName, sRotatedName);
+    }
+    else {
+      ::unlink(sConfig->fileName);
+    }
+    sLastSyncTime = tAppInterface::getLogTime();
+    open();
+  }
+
+  static void write(char const * const aBegin, size_t const aLength) {
+    char const * where = aBegin;
+    size_t remaining = aLength;
+    while(remaining > 0u) {
+      ssize_t written = ::write(sFd, where, remaining);
+      if(written >= 0) {
+        where += written;
+        remaining -= written;
+      }
+      else if(errno != EINTR) {
+        tAppInterface::error(Exception::cSenderError);
+        remaining = 0u;
+      }
+      else { // nothing to do
+      }
+    }
+  }
+};
+
+}
+
+#endif
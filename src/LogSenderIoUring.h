@@ -0,0 +1,447 @@
+#ifndef NOWTECH_LOG_SENDER_IO_URING
+#define NOWTECH_LOG_SENDER_IO_URING
+
+#include "Log.h"
+#include "LogSenderBuffer.h"
+#include <mutex>
+#include <thread>
+#include <cerrno>
+#include <cstring>
+#include <condition_variable>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+namespace nowtech::log {
+
+/// Writes to a file asynchronously using io_uring with a pool of tBufferCount
+/// registered buffers of tBufferSize bytes each. The converter works directly
+/// in the current buffer, which collects groups until it has no room for
+/// another tTransmitBufferSize chunk, its oldest content is older than
+/// tTimeout, or flush() is called. Then its write gets submitted and the
+/// converter continues in the next buffer, while the earlier writes complete.
+/// Writes go to explicit offsets, so their completion order does not matter.
+/// The transmitter blocks only if all buffers are in flight.
+/// If io_uring is unavailable, a worker thread does blocking writes instead.
+/// If the ring fails later, the sender switches to the worker thread without
+/// losing data, so this is not an error, but isUsingIoUring() tells it.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, typename tAppInterface::LogTime tTimeout, size_t tBufferSize, uint32_t tBufferCount>
+class SenderIoUring final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+  using LogTime          = typename tAppInterface::LogTime;
+
+  static constexpr bool csVoid = false;
+
+private:
+  static_assert(std::is_same_v<ConversionResult, char>);
+  static_assert(tBufferSize >= tTransmitBufferSize);
+  static_assert(tBufferCount >= 2u);
+
+  static constexpr int    csInvalidFd = -1;
+  static constexpr mode_t csOpenMode  = 0644;
+
+  using SendBuffer = SenderBuffer<tAppInterface, tConverter, tTransmitBufferSize, tTimeout>;
+
+  struct Buffer final {
+    char             *mData;
+    uint64_t          mFileOffset;
+    uint32_t          mLength;
+    std::atomic<bool> mInFlight;
+  };
+
+  /// Minimal raw io_uring interface to avoid depending on liburing.
+  class Ring final {
+    int                  mFd = csInvalidFd;
+    void                *mSqRing = MAP_FAILED;
+    void                *mCqRing = MAP_FAILED;
+    size_t               mSqRingSize;
+    size_t               mCqRingSize;
+    io_uring_sqe        *mSqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t               mSqesSize;
+    std::atomic<uint32_t> *mSqTail;
+    uint32_t             mSqMask;
+    uint32_t            *mSqArray;
+    std::atomic<uint32_t> *mCqHead;
+    std::atomic<uint32_t> *mCqTail;
+    uint32_t             mCqMask;
+    io_uring_cqe        *mCqes;
+    uint32_t             mToSubmit = 0u;
+    bool                 mFixedBuffers = false;
+
+  public:
+    bool init(Buffer * const aBuffers) noexcept {
+      io_uring_params params;
+      std::memset(&params, 0, sizeof(params));
+      mFd = static_cast<int>(::syscall(__NR_io_uring_setup, tBufferCount, &params));
+      bool result = mFd >= 0;
+      if(result) {
+        mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if((params.features & IORING_FEAT_SINGLE_MMAP) != 0u) {
+          mSqRingSize = mCqRingSize = std::max(mSqRingSize, mCqRingSize);
+        }
+        else { // nothing to do
+        }
+        mSqRing = ::mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, IORING_OFF_SQ_RING);
+        if((params.features & IORING_FEAT_SINGLE_MMAP) != 0u) {
+          mCqRing = mSqRing;
+        }
+        else if(mSqRing != MAP_FAILED) {
+          mCqRing = ::mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, IORING_OFF_CQ_RING);
+        }
+        else { // nothing to do
+        }
+        mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        mSqes = static_cast<io_uring_sqe*>(::mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, IORING_OFF_SQES));
+        result = mSqRing != MAP_FAILED && mCqRing != MAP_FAILED && mSqes != MAP_FAILED;
+      }
+      else { // nothing to do
+      }
+      if(result) {
+        char *sqRing = static_cast<char*>(mSqRing);
+        char *cqRing = static_cast<char*>(mCqRing);
+        mSqTail  = reinterpret_cast<std::atomic<uint32_t>*>(sqRing + params.sq_off.tail);
+        mSqMask  = *reinterpret_cast<uint32_t*>(sqRing + params.sq_off.ring_mask);
+        mSqArray = reinterpret_cast<uint32_t*>(sqRing + params.sq_off.array);
+        mCqHead  = reinterpret_cast<std::atomic<uint32_t>*>(cqRing + params.cq_off.head);
+        mCqTail  = reinterpret_cast<std::atomic<uint32_t>*>(cqRing + params.cq_off.tail);
+        mCqMask  = *reinterpret_cast<uint32_t*>(cqRing + params.cq_off.ring_mask);
+        mCqes    = reinterpret_cast<io_uring_cqe*>(cqRing + params.cq_off.cqes);
+        iovec iovecs[tBufferCount];
+        for(uint32_t i = 0u; i < tBufferCount; ++i) {
+          iovecs[i].iov_base = aBuffers[i].mData;
+          iovecs[i].iov_len = tBufferSize;
+        }
+        // Registration may fail due to RLIMIT_MEMLOCK, then plain writes are used.
+        mFixedBuffers = ::syscall(__NR_io_uring_register, mFd, IORING_REGISTER_BUFFERS, iovecs, tBufferCount) == 0;
+      }
+      else {
+        done();
+      }
+      return result;
+    }
+
+    void done() noexcept {
+      if(mSqes != MAP_FAILED) {
+        ::munmap(mSqes, mSqesSize);
+        mSqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+      }
+      else { // nothing to do
+      }
+      if(mCqRing != MAP_FAILED && mCqRing != mSqRing) {
+        ::munmap(mCqRing, mCqRingSize);
+      }
+      else { // nothing to do
+      }
+      mCqRing = MAP_FAILED;
+      if(mSqRing != MAP_FAILED) {
+        ::munmap(mSqRing, mSqRingSize);
+        mSqRing = MAP_FAILED;
+      }
+      else { // nothing to do
+      }
+      if(mFd != csInvalidFd) {
+        ::close(mFd);
+        mFd = csInvalidFd;
+      }
+      else { // nothing to do
+      }
+    }
+
+    /// Only prepares the request, enter() makes the kernel see it.
+    void prepareWrite(int const aFileFd, uint32_t const aIndex, Buffer const &aBuffer) noexcept {
+      uint32_t const tail = mSqTail->load(std::memory_order_relaxed);
+      uint32_t const slot = tail & mSqMask;
+      io_uring_sqe &sqe = mSqes[slot];
+      std::memset(&sqe, 0, sizeof(sqe));
+      sqe.opcode = mFixedBuffers ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+      sqe.fd = aFileFd;
+      sqe.addr = reinterpret_cast<uint64_t>(aBuffer.mData);
+      sqe.len = aBuffer.mLength;
+      sqe.off = aBuffer.mFileOffset;
+      sqe.buf_index = mFixedBuffers ? aIndex : 0u;
+      sqe.user_data = aIndex;
+      mSqArray[slot] = slot;
+      mSqTail->store(tail + 1u, std::memory_order_release);
+      ++mToSubmit;
+    }
+
+    /// Submits the prepared requests and waits for at least aMinComplete completions.
+    bool enter(uint32_t const aMinComplete) noexcept {
+      bool result = true;
+      if(mToSubmit > 0u || aMinComplete > 0u) {
+        long submitted = ::syscall(__NR_io_uring_enter, mFd, mToSubmit, aMinComplete, aMinComplete > 0u ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0u);
+        if(submitted >= 0) {
+          mToSubmit -= static_cast<uint32_t>(submitted);
+        }
+        else {
+          result = errno == EINTR || errno == EAGAIN || errno == EBUSY;
+        }
+      }
+      else { // nothing to do
+      }
+      return result;
+    }
+
+    /// Calls aFunction(index, result) for each completed request.
+    template<typename tFunction>
+    void reap(tFunction aFunction) noexcept {
+      uint32_t head = mCqHead->load(std::memory_order_relaxed);
+      uint32_t const tail = mCqTail->load(std::memory_order_acquire);
+      while(head != tail) {
+        io_uring_cqe const &cqe = mCqes[head & mCqMask];
+        aFunction(static_cast<uint32_t>(cqe.user_data), cqe.res);
+        ++head;
+      }
+      mCqHead->store(head, std::memory_order_release);
+    }
+  };
+
+  inline static Ring                    sRing;
+  inline static bool                    sUseRing;
+  inline static int                     sFd = csInvalidFd;
+  inline static char                   *sStorage;
+  inline static Buffer                  sBuffers[tBufferCount];
+  inline static uint32_t                sCurrent;
+  inline static SendBuffer              sSendBuffer;        // Fills sBuffers[sCurrent].
+  inline static uint64_t                sFileOffset;
+  inline static std::atomic<bool>       sWriteFailed;
+
+  // Used only by the fallback worker thread.
+  inline static std::thread             sWorker;
+  inline static std::mutex              sMutex;
+  inline static std::condition_variable sConditionVariable;
+  inline static uint32_t                sNextToWrite;
+  inline static uint32_t                sSubmittedCount;
+  inline static bool                    sKeepAlive;
+
+  SenderIoUring() = delete;
+
+public:
+  /// @param aAllowIoUring can be set to false to use the fallback worker thread in any case.
+  static void init(char const * const aFileName, bool const aAllowIoUring = true) {
+    sFd = ::open(aFileName, O_WRONLY | O_CREAT | O_CLOEXEC, csOpenMode);
+    struct stat status;
+    if(sFd != csInvalidFd && ::fstat(sFd, &status) == 0) {
+      sFileOffset = status.st_size;
+    }
+    else {
+      tAppInterface::error(Exception::cSenderError);
+    }
+    sStorage = tAppInterface::template _newArray<char>(tBufferSize * tBufferCount);
+    for(uint32_t i = 0u; i < tBufferCount; ++i) {
+      sBuffers[i].mData = sStorage + i * tBufferSize;
+      sBuffers[i].mInFlight = false;
+    }
+    sCurrent = 0u;
+    sSendBuffer.reset(sBuffers[0u].mData, sBuffers[0u].mData + tBufferSize);
+    sWriteFailed = false;
+    sUseRing = aAllowIoUring && sRing.init(sBuffers);
+    if(!sUseRing) {
+      startWorker(0u);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void done() {
+    flush();
+    for(uint32_t i = 0u; i < tBufferCount; ++i) {
+      waitForBuffer(i);
+    }
+    if(sUseRing) {
+      sRing.done();
+    }
+    else {
+      {
+        std::lock_guard<std::mutex> lock(sMutex);
+        sKeepAlive = false;
+      }
+      sConditionVariable.notify_all();
+      sWorker.join();
+    }
+    ::close(sFd);
+    sFd = csInvalidFd;
+    tAppInterface::template _deleteArray<char>(sStorage);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) {
+    sSendBuffer.send(aBegin, aEnd, flush);
+    if(sWriteFailed.exchange(false)) {
+      tAppInterface::error(Exception::cSenderError);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static auto getBuffer() {
+    return sSendBuffer.getBuffer();
+  }
+
+  /// False if io_uring was unavailable, not allowed or failed.
+  static bool isUsingIoUring() noexcept {
+    return sUseRing;
+  }
+
+  /// Submits the current buffer if not empty and switches to the next one.
+  /// Returns without waiting for the write to complete.
+  static void flush() {
+    Buffer &buffer = sBuffers[sCurrent];
+    if(!sSendBuffer.isEmpty()) {
+      buffer.mLength = sSendBuffer.getLength();
+      buffer.mFileOffset = sFileOffset;
+      sFileOffset += buffer.mLength;
+      buffer.mInFlight = true;
+      submit(sCurrent);
+      sCurrent = (sCurrent + 1u) % tBufferCount;
+      waitForBuffer(sCurrent);
+      sSendBuffer.reset(sBuffers[sCurrent].mData, sBuffers[sCurrent].mData + tBufferSize);
+    }
+    else if(sUseRing) {
+      sRing.reap(complete);
+    }
+    else { // nothing to do
+    }
+  }
+
+private:
+  static void submit(uint32_t const aIndex) {
+    if(sUseRing) {
+      sRing.prepareWrite(sFd, aIndex, sBuffers[aIndex]);
+      if(!sRing.enter(0u)) {
+        fallBack((aIndex + 1u) % tBufferCount);
+      }
+      else { // nothing to do
+      }
+    }
+    else {
+      {
+        std::lock_guard<std::mutex> lock(sMutex);
+        ++sSubmittedCount;
+      }
+      sConditionVariable.notify_all();
+    }
+  }
+
+  static void waitForBuffer(uint32_t const aIndex) {
+    if(sUseRing) {
+      sRing.reap(complete);
+      while(sUseRing && sBuffers[aIndex].mInFlight) {
+        if(sRing.enter(1u)) {
+          sRing.reap(complete);
+        }
+        else {
+          fallBack(aIndex);
+        }
+      }
+    }
+    else {
+      std::unique_lock<std::mutex> lock(sMutex);
+      sConditionVariable.wait(lock, [aIndex]{ return !sBuffers[aIndex].mInFlight; });
+    }
+  }
+
+  /// Abandons the failed ring and repeats the writes still in flight
+  /// synchronously, which is harmless as they go to explicit offsets.
+  /// aNextToWrite is the index of the buffer to be submitted next.
+  static void fallBack(uint32_t const aNextToWrite) {
+    sRing.done();
+    for(uint32_t i = 0u; i < tBufferCount; ++i) {
+      Buffer &buffer = sBuffers[i];
+      if(buffer.mInFlight) {
+        if(!writeAll(buffer.mData, buffer.mLength, buffer.mFileOffset)) {
+          sWriteFailed = true;
+        }
+        else { // nothing to do
+        }
+        buffer.mInFlight = false;
+      }
+      else { // nothing to do
+      }
+    }
+    sUseRing = false;
+    startWorker(aNextToWrite);
+  }
+
+  static void startWorker(uint32_t const aNextToWrite) {
+    sNextToWrite = aNextToWrite;
+    sSubmittedCount = 0u;
+    sKeepAlive = true;
+    sWorker = std::thread(workerFunction);
+  }
+
+  static void complete(uint32_t const aIndex, int32_t const aResult) noexcept {
+    Buffer &buffer = sBuffers[aIndex];
+    if(aResult < 0) {
+      sWriteFailed = true;
+    }
+    else if(static_cast<uint32_t>(aResult) < buffer.mLength) { // Short write, finish it synchronously.
+      if(!writeAll(buffer.mData + aResult, buffer.mLength - aResult, buffer.mFileOffset + aResult)) {
+        sWriteFailed = true;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    buffer.mInFlight = false;
+  }
+
+  static bool writeAll(char const * const aBegin, size_t const aLength, uint64_t const aFileOffset) noexcept {
+    char const * where = aBegin;
+    size_t remaining = aLength;
+    uint64_t offset = aFileOffset;
+    bool result = true;
+    while(remaining > 0u && result) {
+      ssize_t written = ::pwrite(sFd, where, remaining, offset);
+      if(written >= 0) {
+        where += written;
+        offset += written;
+        remaining -= written;
+      }
+      else {
+        result = errno == EINTR;
+      }
+    }
+    return result;
+  }
+
+  /// Fallback: writes the submitted buffers in order, blocking only itself.
+  static void workerFunction() noexcept {
+    std::unique_lock<std::mutex> lock(sMutex);
+    while(true) {
+      sConditionVariable.wait(lock, []{ return sSubmittedCount > 0u || !sKeepAlive; });
+      if(sSubmittedCount == 0u) {
+        break;
+      }
+      else { // nothing to do
+      }
+      uint32_t const index = sNextToWrite;
+      Buffer &buffer = sBuffers[index];
+      lock.unlock();
+      bool const success = writeAll(buffer.mData, buffer.mLength, buffer.mFileOffset);
+      lock.lock();
+      if(!success) {
+        sWriteFailed = true;
+      }
+      else { // nothing to do
+      }
+      buffer.mInFlight = false;
+      sNextToWrite = (sNextToWrite + 1u) % tBufferCount;
+      --sSubmittedCount;
+      sConditionVariable.notify_all();
+    }
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,273 @@
+#ifndef NOWTECH_LOG_SENDER_MMAP_FILE
+#define NOWTECH_LOG_SENDER_MMAP_FILE
+
+#include "Log.h"
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace nowtech::log {
+
+/// Layout of the beginning of the ring file, followed by the ring data itself.
+/// mWriteOffset counts all bytes ever written, so the ring position is
+/// mWriteOffset % mCapacity, and a reader can detect when it was overrun.
+/// mReserveOffset is advanced before the writer starts copying, and
+/// mWriteOffset after it finished, so bytes below mReserveOffset - mCapacity
+/// may already be overwritten, while bytes below mWriteOffset are complete.
+struct MmapRingHeader final {
+  static constexpr char     csMagic[8]  = {'N', 'T', 'L', 'O', 'G', 'R', 'N', 'G'};
+  static constexpr uint32_t csVersion   = 2u;
+  static constexpr size_t   csDataStart = 64u;   // Keeps the data cache line aligned.
+
+  char                  mMagic[sizeof(csMagic)];
+  uint32_t              mVersion;
+  uint32_t              mReserved;
+  uint64_t              mCapacity;
+  std::atomic<uint64_t> mWriteOffset;
+  std::atomic<uint64_t> mReserveOffset;
+
+  bool isValid(uint64_t const aFileSize) const noexcept {
+    return std::memcmp(mMagic, csMagic, sizeof(csMagic)) == 0 && mVersion == csVersion && mCapacity + csDataStart == aFileSize;
+  }
+};
+
+static_assert(sizeof(MmapRingHeader) <= MmapRingHeader::csDataStart);
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+
+/// Stores the converted output in a preallocated file mapped in memory as a
+/// circular buffer. Sending is a memcpy between the reservation and the
+/// publication of the new write offset, the kernel writes back the pages in
+/// the background, and the content survives crashes of the process. An
+/// existing ring of the same capacity is continued, otherwise it is
+/// reinitialized. Use MmapFileTailer or tools/logtail.cpp to read it.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize>
+class SenderMmapFile final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+
+  static constexpr bool csVoid = false;
+
+private:
+  static_assert(std::is_same_v<ConversionResult, char>);
+
+  static constexpr int    csInvalidFd = -1;
+  static constexpr mode_t csOpenMode  = 0644;
+
+  inline static MmapRingHeader   *sHeader = nullptr;
+  inline static char             *sData;
+  inline static uint64_t          sCapacity;
+  inline static uint64_t          sMappedSize;
+  inline static ConversionResult *sTransmitBuffer;
+  inline static Iterator          sBegin;
+  inline static Iterator          sEnd;
+
+  SenderMmapFile() = delete;
+
+public:
+  /// @param aCapacity size of the ring data in bytes, the file will be 64 bytes longer.
+  static void init(char const * const aFileName, uint64_t const aCapacity) {
+    sTransmitBuffer = tAppInterface::template _newArray<ConversionResult>(tTransmitBufferSize);
+    sBegin = sTransmitBuffer;
+    sEnd = sTransmitBuffer + tTransmitBufferSize;
+    sCapacity = aCapacity;
+    sMappedSize = aCapacity + MmapRingHeader::csDataStart;
+    int fd = ::open(aFileName, O_RDWR | O_CREAT | O_CLOEXEC, csOpenMode);
+    struct stat status;
+    bool mappedFine = false;
+    if(fd != csInvalidFd && ::fstat(fd, &status) == 0 && ::posix_fallocate(fd, 0, sMappedSize) == 0) {
+      void *mapped = ::mmap(nullptr, sMappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if(mapped != MAP_FAILED) {
+        mappedFine = true;
+        sHeader = static_cast<MmapRingHeader*>(mapped);
+        sData = static_cast<char*>(mapped) + MmapRingHeader::csDataStart;
+        if(!sHeader->isValid(static_cast<uint64_t>(status.st_size))) {
+          if(static_cast<uint64_t>(status.st_size) > sMappedSize) {
+            ::ftruncate(fd, sMappedSize);
+          }
+          else { // nothing to do
+          }
+          sHeader->mVersion = MmapRingHeader::csVersion;
+          sHeader->mReserved = 0u;
+          sHeader->mCapacity = aCapacity;
+          sHeader->mWriteOffset.store(0u, std::memory_order_relaxed);
+          sHeader->mReserveOffset.store(0u, std::memory_order_relaxed);
+          std::memcpy(sHeader->mMagic, MmapRingHeader::csMagic, sizeof(MmapRingHeader::csMagic));
+        }
+        else { // A crash during copying leaves a torn frame, which is kept as content.
+          sHeader->mWriteOffset.store(sHeader->mReserveOffset.load(std::memory_order_relaxed), std::memory_order_release);
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    if(fd != csInvalidFd) {
+      ::close(fd);     // The mapping keeps the file referenced.
+    }
+    else { // nothing to do
+    }
+    if(!mappedFine) {  // error() may throw, so the fd is closed before.
+      tAppInterface::error(Exception::cSenderError);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void done() noexcept {
+    if(sHeader != nullptr) {
+      ::msync(sHeader, sMappedSize, MS_ASYNC);
+      ::munmap(sHeader, sMappedSize);
+      sHeader = nullptr;
+    }
+    else { // nothing to do
+    }
+    tAppInterface::template _deleteArray<ConversionResult>(sTransmitBuffer);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) noexcept {
+    if(sHeader != nullptr) {
+      uint64_t const offset = sHeader->mWriteOffset.load(std::memory_order_relaxed);
+      uint64_t length = aEnd - aBegin;
+      char const * where = aBegin;
+      if(length > sCapacity) {   // Only the tail would survive anyway.
+        where += length - sCapacity;
+        length = sCapacity;
+      }
+      else { // nothing to do
+      }
+      sHeader->mReserveOffset.store(offset + length, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);   // Readers must see the reservation before any overwritten byte.
+      uint64_t const position = offset % sCapacity;
+      uint64_t const first = std::min(length, sCapacity - position);
+      std::memcpy(sData + position, where, first);
+      std::memcpy(sData, where + first, length - first);
+      sHeader->mWriteOffset.store(offset + length, std::memory_order_release);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void flush() noexcept { // The kernel does the writeback.
+  }
+
+  static auto getBuffer() {
+    return std::pair(sBegin, sEnd);
+  }
+};
+
+/// Follows a ring file written by SenderMmapFile, possibly in an other process.
+class MmapFileTailer final {
+private:
+  static constexpr int csInvalidFd = -1;
+
+  MmapRingHeader const *mHeader = nullptr;
+  char const           *mData;
+  uint64_t              mMappedSize;
+  uint64_t              mReadOffset;
+  uint64_t              mSkippedCount = 0u;
+
+public:
+  MmapFileTailer() noexcept = default;
+  MmapFileTailer(MmapFileTailer const &) = delete;
+  MmapFileTailer& operator=(MmapFileTailer const &) = delete;
+
+  ~MmapFileTailer() noexcept {
+    if(mHeader != nullptr) {
+      ::munmap(const_cast<MmapRingHeader*>(mHeader), mMappedSize);
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// @param aFromStart if true, reading starts at the oldest content still
+  /// in the ring, otherwise at the current end.
+  bool open(char const * const aFileName, bool const aFromStart) noexcept {
+    bool result = false;
+    int fd = ::open(aFileName, O_RDONLY | O_CLOEXEC);
+    struct stat status;
+    if(fd != csInvalidFd && ::fstat(fd, &status) == 0 && static_cast<uint64_t>(status.st_size) > MmapRingHeader::csDataStart) {
+      mMappedSize = status.st_size;
+      void *mapped = ::mmap(nullptr, mMappedSize, PROT_READ, MAP_SHARED, fd, 0);
+      if(mapped != MAP_FAILED) {
+        mHeader = static_cast<MmapRingHeader const*>(mapped);
+        mData = static_cast<char const*>(mapped) + MmapRingHeader::csDataStart;
+        result = mHeader->isValid(mMappedSize);
+        uint64_t const writeOffset = mHeader->mWriteOffset.load(std::memory_order_acquire);
+        if(!aFromStart) {
+          mReadOffset = writeOffset;
+        }
+        else if(writeOffset > mHeader->mCapacity) {
+          mReadOffset = writeOffset - mHeader->mCapacity;
+        }
+        else {
+          mReadOffset = 0u;
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+    if(fd != csInvalidFd) {
+      ::close(fd);
+    }
+    else { // nothing to do
+    }
+    return result;
+  }
+
+  /// Copies at most aSize new bytes in aBuffer and returns the count copied,
+  /// which is 0 only if there is no new content. If the writer has overrun
+  /// the reader, even during copying, reading resumes at the oldest intact
+  /// content, and the lost bytes are added to getSkippedCount().
+  uint64_t read(char * const aBuffer, uint64_t const aSize) noexcept {
+    uint64_t const capacity = mHeader->mCapacity;
+    uint64_t result = 0u;
+    bool torn;
+    do {
+      uint64_t const writeOffset = mHeader->mWriteOffset.load(std::memory_order_acquire);
+      skipOverwritten(writeOffset, capacity);
+      uint64_t const length = std::min(aSize, writeOffset - mReadOffset);
+      uint64_t const position = mReadOffset % capacity;
+      uint64_t const first = std::min(length, capacity - position);
+      std::memcpy(aBuffer, mData + position, first);
+      std::memcpy(aBuffer + first, mData, length - first);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint64_t const reserveOffset = mHeader->mReserveOffset.load(std::memory_order_relaxed);
+      torn = reserveOffset - mReadOffset > capacity;   // The writer may have overwritten what we were copying.
+      if(torn) {
+        skipOverwritten(reserveOffset, capacity);
+      }
+      else {
+        mReadOffset += length;
+        result = length;
+      }
+    } while(torn);
+    return result;
+  }
+
+  uint64_t getSkippedCount() const noexcept {
+    return mSkippedCount;
+  }
+
+private:
+  void skipOverwritten(uint64_t const aOffset, uint64_t const aCapacity) noexcept {
+    if(aOffset - mReadOffset > aCapacity) {
+      mSkippedCount += aOffset - aCapacity - mReadOffset;
+      mReadOffset = aOffset - aCapacity;
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+}
+
+#endif
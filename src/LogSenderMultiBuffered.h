@@ -0,0 +1,124 @@
+#ifndef NOWTECH_LOG_SENDER_MULTI_BUFFERED
+#define NOWTECH_LOG_SENDER_MULTI_BUFFERED
+
+#include "Log.h"
+#include "LogSenderBuffer.h"
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <condition_variable>
+
+namespace nowtech::log {
+
+/// Wraps a blocking sender to let conversion and sending overlap. The
+/// converter fills one of tBufferCount buffers of tBufferSize while a worker
+/// thread sends the earlier filled ones in order using the wrapped sender.
+/// A buffer is handed over when it has no room for another
+/// tTransmitBufferSize chunk, its oldest content is older than tTimeout, or on
+/// flush(). The transmitter blocks only if all the other buffers are still
+/// waiting to be sent. init() and done() initialize and shut down the wrapped
+/// sender as well, but its getBuffer() is not used.
+template<typename tSender, size_t tTransmitBufferSize, typename tSender::tAppInterface_::LogTime tTimeout, size_t tBufferSize, uint32_t tBufferCount>
+class SenderMultiBuffered final {
+public:
+  using tAppInterface_   = typename tSender::tAppInterface_;
+  using tConverter_      = typename tSender::tConverter_;
+  using ConversionResult = typename tConverter_::ConversionResult;
+  using Iterator         = typename tConverter_::Iterator;
+  using LogTime          = typename tAppInterface_::LogTime;
+
+  static constexpr bool csVoid = tSender::csVoid;
+
+private:
+  using SendBuffer = SenderBuffer<tAppInterface_, tConverter_, tTransmitBufferSize, tTimeout>;
+
+  static_assert(tBufferSize >= tTransmitBufferSize);
+  static_assert(tBufferCount >= 2u);
+
+  inline static ConversionResult       *sStorage;
+  inline static size_t                  sLengths[tBufferCount];
+  inline static SendBuffer              sSendBuffer;        // The one being filled.
+  inline static std::thread             sWorker;
+  inline static std::mutex              sMutex;
+  inline static std::condition_variable sConditionVariable;
+  inline static uint64_t                sSubmittedCount;    // Only the transmitter writes it.
+  inline static uint64_t                sSentCount;         // Only the worker writes it.
+  inline static bool                    sKeepAlive;
+
+  SenderMultiBuffered() = delete;
+
+public:
+  /// aArgs are passed to the init() of the wrapped sender.
+  template<typename ...tArgs>
+  static void init(tArgs&&... aArgs) {
+    tSender::init(std::forward<tArgs>(aArgs)...);
+    sStorage = tAppInterface_::template _newArray<ConversionResult>(tBufferSize * tBufferCount);
+    sSubmittedCount = 0u;
+    sSentCount = 0u;
+    sSendBuffer.reset(sStorage, sStorage + tBufferSize);
+    sKeepAlive = true;
+    sWorker = std::thread(workerFunction);
+  }
+
+  static void done() {
+    flush();
+    {
+      std::lock_guard<std::mutex> lock(sMutex);
+      sKeepAlive = false;
+    }
+    sConditionVariable.notify_all();
+    sWorker.join();
+    tSender::done();
+    tAppInterface_::template _deleteArray<ConversionResult>(sStorage);
+  }
+
+  static void send(ConversionResult const * const aBegin, ConversionResult const * const aEnd) {
+    sSendBuffer.send(aBegin, aEnd, flush);
+  }
+
+  static auto getBuffer() {
+    return sSendBuffer.getBuffer();
+  }
+
+  /// Hands over the current buffer if not empty, and waits until the next one is free.
+  static void flush() {
+    if(!sSendBuffer.isEmpty()) {
+      std::unique_lock<std::mutex> lock(sMutex);
+      sLengths[sSubmittedCount % tBufferCount] = sSendBuffer.getLength();
+      ++sSubmittedCount;
+      sConditionVariable.notify_all();
+      sConditionVariable.wait(lock, []{ return sSubmittedCount - sSentCount < tBufferCount; });
+      lock.unlock();
+      Iterator const next = sStorage + (sSubmittedCount % tBufferCount) * tBufferSize;
+      sSendBuffer.reset(next, next + tBufferSize);
+    }
+    else { // nothing to do
+    }
+  }
+
+private:
+
+  static void workerFunction() noexcept {
+    std::unique_lock<std::mutex> lock(sMutex);
+    while(true) {
+      sConditionVariable.wait(lock, []{ return sSentCount != sSubmittedCount || !sKeepAlive; });
+      if(sSentCount == sSubmittedCount) {
+        break;
+      }
+      else { // nothing to do
+      }
+      uint64_t const index = sSentCount % tBufferCount;
+      lock.unlock();
+      ConversionResult const * const begin = sStorage + index * tBufferSize;
+      tSender::send(begin, begin + sLengths[index]);
+      tSender::flush();
+      lock.lock();
+      ++sSentCount;
+      sConditionVariable.notify_all();
+    }
+  }
+};
+
+}
+
+#endif
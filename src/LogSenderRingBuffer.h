@@ -0,0 +1,146 @@
+#ifndef NOWTECH_LOG_SENDER_RING_BUFFER
+#define NOWTECH_LOG_SENDER_RING_BUFFER
+
+#include "Log.h"
+#include <mutex>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+namespace nowtech::log {
+
+/// Flight recorder keeping the last tCapacity bytes of the converted output
+/// in a preallocated circular buffer. Sending costs a memcpy under a mutex.
+/// dump() spills the recorded history to a file descriptor on demand, from
+/// any thread. It copies the ring in chunks of tDumpChunkSize under the
+/// mutex and writes them without holding it, so the transmitter waits at
+/// most for one chunk copy. If logging overruns the dump in the meantime,
+/// the dump skips to the oldest content still intact.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, size_t tCapacity, size_t tDumpChunkSize = 64u * 1024u>
+class SenderRingBuffer final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+
+  static constexpr bool csVoid = false;
+
+private:
+  static_assert(std::is_same_v<ConversionResult, char>);
+  static_assert(tCapacity > 0u && tDumpChunkSize > 0u);
+
+  inline static char             *sRing;
+  inline static uint64_t          sWriteOffset;   // Counts all bytes ever sent.
+  inline static std::mutex        sMutex;
+  inline static std::mutex        sDumpMutex;     // Serializes dumps sharing the chunk buffer.
+  inline static char             *sDumpChunk;
+  inline static ConversionResult *sTransmitBuffer;
+  inline static Iterator          sBegin;
+  inline static Iterator          sEnd;
+
+  SenderRingBuffer() = delete;
+
+public:
+  static void init() {
+    sRing = tAppInterface::template _newArray<char>(tCapacity);
+    sDumpChunk = tAppInterface::template _newArray<char>(tDumpChunkSize);
+    sTransmitBuffer = tAppInterface::template _newArray<ConversionResult>(tTransmitBufferSize);
+    sBegin = sTransmitBuffer;
+    sEnd = sTransmitBuffer + tTransmitBufferSize;
+    sWriteOffset = 0u;
+  }
+
+  static void done() noexcept {
+    tAppInterface::template _deleteArray<ConversionResult>(sTransmitBuffer);
+    tAppInterface::template _deleteArray<char>(sDumpChunk);
+    tAppInterface::template _deleteArray<char>(sRing);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) noexcept {
+    uint64_t length = aEnd - aBegin;
+    char const * where = aBegin;
+    if(length > tCapacity) {   // Only the tail would survive anyway.
+      where += length - tCapacity;
+      length = tCapacity;
+    }
+    else { // nothing to do
+    }
+    std::lock_guard<std::mutex> lock(sMutex);
+    uint64_t const position = (sWriteOffset + (where - aBegin)) % tCapacity;
+    uint64_t const first = std::min<uint64_t>(length, tCapacity - position);
+    std::memcpy(sRing + position, where, first);
+    std::memcpy(sRing, where + first, length - first);
+    sWriteOffset += aEnd - aBegin;
+  }
+
+  static void flush() noexcept { // Nothing is buffered outside the ring.
+  }
+
+  static auto getBuffer() {
+    return std::pair(sBegin, sEnd);
+  }
+
+  /// Writes the recorded history up to the moment of the call, oldest first, to aFd.
+  /// @return false on write error.
+  static bool dump(int const aFd) noexcept {
+    std::lock_guard<std::mutex> dumpLock(sDumpMutex);
+    uint64_t readOffset;
+    uint64_t endOffset;
+    {
+      std::lock_guard<std::mutex> lock(sMutex);
+      endOffset = sWriteOffset;
+      readOffset = (endOffset > tCapacity ? endOffset - tCapacity : 0u);
+    }
+    bool result = true;
+    while(result && readOffset < endOffset) {
+      uint64_t length;
+      {
+        std::lock_guard<std::mutex> lock(sMutex);
+        if(sWriteOffset - readOffset > tCapacity) {
+          readOffset = sWriteOffset - tCapacity;
+        }
+        else { // nothing to do
+        }
+        length = (readOffset < endOffset ? std::min<uint64_t>(endOffset - readOffset, tDumpChunkSize) : 0u);
+        uint64_t const position = readOffset % tCapacity;
+        uint64_t const first = std::min<uint64_t>(length, tCapacity - position);
+        std::memcpy(sDumpChunk, sRing + position, first);
+        std::memcpy(sDumpChunk + first, sRing, length - first);
+      }
+      readOffset += length;
+      result = write(aFd, sDumpChunk, length);
+    }
+    return result;
+  }
+
+  /// Total bytes sent since init(), including those already overwritten.
+  static uint64_t getTotalSize() noexcept {
+    std::lock_guard<std::mutex> lock(sMutex);
+    return sWriteOffset;
+  }
+
+private:
+  static bool write(int const aFd, char const * const aBegin, size_t const aLength) noexcept {
+    char const * where = aBegin;
+    size_t remaining = aLength;
+    bool result = true;
+    while(result && remaining > 0u) {
+      ssize_t written = ::write(aFd, where, remaining);
+      if(written >= 0) {
+        where += written;
+        remaining -= written;
+      }
+      else if(errno != EINTR) {
+        result = false;
+      }
+      else { // nothing to do
+      }
+    }
+    return result;
+  }
+};
+
+}
+
+#endif
@@ -6,7 +6,7 @@
 
 namespace nowtech::log {
 
-// For slow transmission medium like UART on embedded this class could implement double buffering.
+// For double buffering, wrap it in SenderMultiBuffered.
 template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, typename tAppInterface::LogTime tTimeout>
 class SenderStdOstream final {
 public:
@@ -49,6 +49,18 @@ public:
     }
   }
 
+  static void flush() {
+    try {
+      if(sStream != nullptr) {
+        sStream->flush();
+      }
+      else { // nothing to do
+      }
+    } catch(...) {
+      tAppInterface::error(Exception::cSenderError);
+    }
+  }
+
   static auto getBuffer() {
     return std::pair(sBegin, sEnd);
   }
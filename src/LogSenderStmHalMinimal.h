@@ -10,7 +10,10 @@
 
 namespace nowtech::log {
 
-// For slow transmission medium like UART on embedded this class could implement double buffering.
+// Blocks in send() until the UART has transmitted everything. SenderMultiBuffered
+// overlaps conversion and sending, but it needs std::thread. Here the same could be
+// done by returning the next of several buffers from getBuffer() after each send(),
+// and transmitting the filled one using HAL_UART_Transmit_DMA.
 template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, typename tAppInterface::LogTime tTimeout>
 class SenderStmHalMinimal final {
 public:
@@ -48,6 +51,9 @@ public:
     }
   }
 
+  static void flush() noexcept { // nothing to do
+  }
+
   static auto getBuffer() {
     return std::pair(sBegin, sEnd);
   }
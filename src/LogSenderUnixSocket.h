@@ -0,0 +1,252 @@
+#ifndef NOWTECH_LOG_SENDER_UNIX_SOCKET
+#define NOWTECH_LOG_SENDER_UNIX_SOCKET
+
+#include "Log.h"
+#include "LogSenderBuffer.h"
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+namespace nowtech::log {
+
+enum class UnixSocketMode : uint8_t {
+  cStream   = 0u,
+  cDatagram = 1u
+};
+
+/// Sends to a local collector over a Unix domain socket. The converter works
+/// directly in a frame buffer of tFrameSize, which collects groups until it
+/// has no room for another tTransmitBufferSize chunk, its oldest content is
+/// older than tTimeout, or on flush(). A frame is sent with one non-blocking
+/// call, as one datagram in datagram mode. Whatever the socket does not
+/// accept goes to a backlog of tBacklogSize bytes, which is sent first on
+/// later flushes. If the collector is not available, connecting is retried
+/// at most once per reconnect period, without blocking the transmitter.
+/// Frames not fitting in the backlog are dropped and counted. In stream mode
+/// a frame cut by a lost connection is sent again whole on the next one.
+template<typename tAppInterface, typename tConverter, size_t tTransmitBufferSize, typename tAppInterface::LogTime tTimeout, size_t tFrameSize, size_t tBacklogSize>
+class SenderUnixSocket final {
+public:
+  using tAppInterface_   = tAppInterface;
+  using tConverter_      = tConverter;
+  using ConversionResult = typename tConverter::ConversionResult;
+  using Iterator         = typename tConverter::Iterator;
+  using LogTime          = typename tAppInterface::LogTime;
+
+  static constexpr bool csVoid = false;
+
+private:
+  using FrameLength = uint32_t;
+  using SendBuffer  = SenderBuffer<tAppInterface, tConverter, tTransmitBufferSize, tTimeout>;
+
+  static_assert(std::is_same_v<ConversionResult, char>);
+  static_assert(tFrameSize >= tTransmitBufferSize);
+  static_assert(tBacklogSize >= tFrameSize + sizeof(FrameLength));
+
+  static constexpr int      csInvalidFd      = -1;
+  static constexpr int      csSendFlags      = MSG_NOSIGNAL | MSG_DONTWAIT;
+  static constexpr uint32_t csDoneTimeoutMs  = 1000u;   // done() waits at most this long for the collector per call.
+  static constexpr uint32_t csMsInSec        = 1000u;
+  static constexpr uint32_t csUsInMs         = 1000u;
+
+  inline static sockaddr_un       sAddress;
+  inline static int               sSocketType;
+  inline static LogTime           sReconnectPeriod;
+  inline static LogTime           sLastConnectTime;
+  inline static int               sFd = csInvalidFd;
+  inline static ConversionResult *sFrame;
+  inline static SendBuffer        sSendBuffer;
+  inline static char             *sBacklog;
+  inline static size_t            sBacklogHead;        // Start of the oldest frame record.
+  inline static size_t            sBacklogEnd;
+  inline static size_t            sHeadSent;           // Bytes of the oldest frame already sent in stream mode.
+  inline static uint64_t          sDroppedCount;
+
+  SenderUnixSocket() = delete;
+
+public:
+  /// @param aPath socket path of the collector, at most 107 characters.
+  /// @param aReconnectPeriod minimum time between connection attempts in ms.
+  static void init(char const * const aPath, UnixSocketMode const aMode, LogTime const aReconnectPeriod) {
+    std::memset(&sAddress, 0, sizeof(sAddress));
+    sAddress.sun_family = AF_UNIX;
+    if(std::strlen(aPath) < sizeof(sAddress.sun_path)) {
+      std::strcpy(sAddress.sun_path, aPath);
+    }
+    else {
+      tAppInterface::error(Exception::cSenderError);
+    }
+    sSocketType = (aMode == UnixSocketMode::cStream ? SOCK_STREAM : SOCK_DGRAM);
+    sReconnectPeriod = aReconnectPeriod;
+    sFrame = tAppInterface::template _newArray<ConversionResult>(tFrameSize);
+    sSendBuffer.reset(sFrame, sFrame + tFrameSize);
+    sBacklog = tAppInterface::template _newArray<char>(tBacklogSize);
+    sBacklogHead = 0u;
+    sBacklogEnd = 0u;
+    sHeadSent = 0u;
+    sDroppedCount = 0u;
+    connect();
+  }
+
+  /// Gives the collector some time to take the backlog, then closes the connection.
+  static void done() noexcept {
+    flush();
+    if(sFd != csInvalidFd && sBacklogEnd > sBacklogHead) {
+      timeval timeout { csDoneTimeoutMs / csMsInSec, (csDoneTimeoutMs % csMsInSec) * csUsInMs };
+      ::setsockopt(sFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+      ::fcntl(sFd, F_SETFL, ::fcntl(sFd, F_GETFL) & ~O_NONBLOCK);
+      drain(MSG_NOSIGNAL);
+    }
+    else { // nothing to do
+    }
+    disconnect();
+    tAppInterface::template _deleteArray<char>(sBacklog);
+    tAppInterface::template _deleteArray<ConversionResult>(sFrame);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) {
+    sSendBuffer.send(aBegin, aEnd, flush);
+  }
+
+  static auto getBuffer() {
+    return sSendBuffer.getBuffer();
+  }
+
+  /// Sends the backlog and the current frame as far as the socket accepts them.
+  static void flush() noexcept {
+    if(sFd == csInvalidFd && tAppInterface::getLogTime() - sLastConnectTime >= sReconnectPeriod) {
+      connect();
+    }
+    else { // nothing to do
+    }
+    drain(csSendFlags);
+    if(!sSendBuffer.isEmpty()) {
+      size_t const length = sSendBuffer.getLength();
+      size_t sent = 0u;
+      if(sBacklogEnd == sBacklogHead) {
+        sent = write(sFrame, length, csSendFlags);
+      }
+      else { // nothing to do
+      }
+      if(sent < length) {
+        store(sFrame, length);   // The backlog is empty here, so the frame fits.
+        sHeadSent = sFd != csInvalidFd ? sent : 0u;
+      }
+      else { // nothing to do
+      }
+      sSendBuffer.clear();
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Number of frames lost because the backlog was full or the collector did not take them.
+  static uint64_t getDroppedCount() noexcept {
+    return sDroppedCount;
+  }
+
+private:
+  /// Connecting a Unix domain socket does not block: it either succeeds or fails at once.
+  static void connect() noexcept {
+    sLastConnectTime = tAppInterface::getLogTime();
+    sFd = ::socket(AF_UNIX, sSocketType | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(sFd != csInvalidFd && ::connect(sFd, reinterpret_cast<sockaddr const*>(&sAddress), sizeof(sAddress)) != 0) {
+      disconnect();
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// The rest of a partly sent frame would be garbage on a new connection,
+  /// so the frame will be sent from its beginning.
+  static void disconnect() noexcept {
+    if(sFd != csInvalidFd) {
+      ::close(sFd);
+      sFd = csInvalidFd;
+      sHeadSent = 0u;
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Returns the number of bytes the socket took. A datagram is taken whole
+  /// or not at all. Errors other than a full socket buffer drop the connection.
+  static size_t write(char const * const aBegin, size_t const aLength, int const aFlags) noexcept {
+    size_t result = 0u;
+    while(sFd != csInvalidFd && result < aLength) {
+      ssize_t sent = ::send(sFd, aBegin + result, aLength - result, aFlags);
+      if(sent >= 0) {
+        result += sent;
+      }
+      else if(errno == EINTR) { // nothing to do
+      }
+      else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+        break;
+      }
+      else if(errno == EMSGSIZE) {   // Would never fit, so drop it.
+        ++sDroppedCount;
+        result = aLength;
+      }
+      else {
+        disconnect();
+      }
+    }
+    return result;
+  }
+
+  /// Sends the oldest frames of the backlog while the socket accepts them.
+  static void drain(int const aFlags) noexcept {
+    while(sFd != csInvalidFd && sBacklogHead < sBacklogEnd) {
+      FrameLength length;
+      std::memcpy(&length, sBacklog + sBacklogHead, sizeof(length));
+      char const * const frame = sBacklog + sBacklogHead + sizeof(length);
+      size_t const sent = write(frame + sHeadSent, length - sHeadSent, aFlags);
+      if(sHeadSent + sent == length) {
+        sBacklogHead += sizeof(length) + length;
+        sHeadSent = 0u;
+      }
+      else {
+        if(sSocketType == SOCK_STREAM && sFd != csInvalidFd) {
+          sHeadSent += sent;
+        }
+        else { // nothing to do
+        }
+        break;
+      }
+    }
+    if(sBacklogHead == sBacklogEnd) {
+      sBacklogHead = 0u;
+      sBacklogEnd = 0u;
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Appends a frame to the backlog, compacting it first if needed.
+  static void store(char const * const aBegin, size_t const aLength) noexcept {
+    if(sBacklogEnd + sizeof(FrameLength) + aLength > tBacklogSize && sBacklogHead > 0u) {
+      std::memmove(sBacklog, sBacklog + sBacklogHead, sBacklogEnd - sBacklogHead);
+      sBacklogEnd -= sBacklogHead;
+      sBacklogHead = 0u;
+    }
+    else { // nothing to do
+    }
+    if(sBacklogEnd + sizeof(FrameLength) + aLength <= tBacklogSize) {
+      FrameLength const length = aLength;
+      std::memcpy(sBacklog + sBacklogEnd, &length, sizeof(length));
+      std::memcpy(sBacklog + sBacklogEnd + sizeof(length), aBegin, aLength);
+      sBacklogEnd += sizeof(length) + aLength;
+    }
+    else {
+      ++sDroppedCount;
+    }
+  }
+};
+
+}
+
+#endif
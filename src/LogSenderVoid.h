@@ -29,6 +29,9 @@ public:
   static void send(char const * const, char const * const) { // nothing to do
   }
 
+  static void flush() noexcept { // nothing to do
+  }
+
   static auto getBuffer() {
     return std::pair(tConverter::csIteratorVoid, tConverter::csIteratorVoid);
   }
@@ -0,0 +1,505 @@
+#ifndef NOWTECH_LOG_STATISTICS_ATOMIC
+#define NOWTECH_LOG_STATISTICS_ATOMIC
+
+#include "LogMessageBase.h"
+#include <bit>
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace nowtech::log {
+
+/// Runtime statistics of Log, read using Log::getStatistics(). Producers
+/// count their pushes in tShardCount cache-line padded shards selected by
+/// the task ID, everything else is written only by the transmitter (or
+/// under the send lock in direct mode), so it needs no read-modify-write.
+/// For the enqueue-to-send latency each task puts the start time of its
+/// groups in a small single-producer single-consumer ring, tagged with the
+/// group index, as long as the ring has room. The transmitter counts the
+/// groups of each task arriving, so it knows if the group it is about to
+/// send has a sample. Samples are never overwritten, so groups waiting long
+/// are measured as well. Groups logged from ISRs are not sampled.
+/// Sampled groups have their queue wait (until the transmitter starts
+/// converting them) and total latency (until sending starts) recorded,
+/// while conversion and send durations are recorded for all groups.
+/// All these go in log-linear histograms of microseconds.
+/// The transmitter also counts the messages and bytes it sends and the
+/// messages lost per topic and per task ID, so chatty subsystems show up.
+/// tMaxTopicCount must be at least that of Log, topics beyond it and
+/// untopiced groups are counted together.
+template<typename tAppInterface, LogTopic tMaxTopicCount, size_t tShardCount = 8u>
+class StatisticsAtomic final {
+public:
+  using tAppInterface_  = tAppInterface;
+  using PerformanceTime = typename tAppInterface::PerformanceTime;
+
+  static constexpr bool     csEnabled          = true;
+  /// Below csSubBucketCount each value has its own bucket, above each power
+  /// of two is split into csSubBucketCount equal buckets, so the relative
+  /// error is at most 1 / csSubBucketCount.
+  static constexpr uint32_t csSubBucketBits    = 2u;
+  static constexpr uint32_t csSubBucketCount   = 1u << csSubBucketBits;
+  static constexpr size_t   csBucketCount      = csSubBucketCount + (std::numeric_limits<PerformanceTime>::digits - csSubBucketBits) * csSubBucketCount;
+  static constexpr size_t   csReportLineCount  = 6u;
+
+  using Histogram = std::array<uint64_t, csBucketCount>;
+
+  struct Volume final {
+    uint64_t messageCount = 0u;   // Messages sent in complete groups.
+    uint64_t byteCount    = 0u;   // Converted bytes sent.
+    uint64_t droppedCount = 0u;   // Messages lost due to full queue, sequence gap, pool exhaustion or quota.
+    uint64_t overQuotaCount = 0u; // Messages dropped because the task had its pool quota full.
+  };
+
+  static constexpr size_t csTopicSlotCount = static_cast<size_t>(tMaxTopicCount) + 1u;  // The last one is for untopiced groups.
+  static constexpr size_t csTaskSlotCount  = tAppInterface::csMaxTaskCount + 1u;        // Indexed by TaskId, 0 is for ISRs.
+
+  /// Counters are read one by one, so they may be inconsistent with each other a bit.
+  struct Snapshot final {
+    uint64_t pushedCount         = 0u;   // Messages entering the queue.
+    uint64_t pushFailedCount     = 0u;   // Messages dropped because the queue was full.
+    uint64_t poppedCount         = 0u;
+    uint64_t sendCount           = 0u;   // Calls to the sender.
+    uint64_t bytesSent           = 0u;
+    uint64_t discardedGroupCount = 0u;   // Partial groups thrown away due to a sequence gap or pool exhaustion.
+    uint64_t sequenceGapCount    = 0u;   // Messages arriving out of sequence.
+    uint64_t poolExhaustedCount  = 0u;   // Messages dropped because the transmitter pool was full.
+    uint64_t overQuotaCount      = 0u;   // Messages dropped because their task had its pool quota full.
+    uint64_t queueHighWatermark  = 0u;   // Messages, measured when popping.
+    uint64_t poolHighWatermark   = 0u;   // Messages held in partial groups.
+    uint64_t senderDroppedCount  = 0u;   // Filled in by Log if the sender counts its losses.
+    Histogram queueWaitHistogram {};      // From the end of the group until the transmitter starts converting it, sampled.
+    Histogram convertHistogram {};        // Conversion of the group, each.
+    Histogram sendHistogram {};           // Time spent in the sender, each.
+    Histogram latencyHistogram {};        // From the end of the group until sending starts, sampled.
+    std::array<Volume, csTopicSlotCount> topicVolumes {};
+    std::array<Volume, csTaskSlotCount>  taskVolumes {};
+  };
+
+private:
+  static constexpr size_t csCacheLineSize     = 64u;
+  static constexpr size_t csLatencySlotCount  = 4u;
+  static constexpr TaskId csIsrTaskId         = tAppInterface::csIsrTaskId;
+  static constexpr uint32_t csIndexShift      = std::numeric_limits<uint32_t>::digits;
+
+  static_assert(tShardCount > 0u);
+  static_assert(tMaxTopicCount > 0);
+  static_assert(sizeof(PerformanceTime) <= sizeof(uint32_t));
+
+  struct alignas(csCacheLineSize) Shard final {
+    std::atomic<uint64_t> mPushedCount;
+    std::atomic<uint64_t> mPushFailedCount;
+  };
+
+  struct alignas(csCacheLineSize) TaskLatency final {
+    std::array<std::atomic<uint64_t>, csLatencySlotCount> mSlots;  // Group index in the upper half, start time in the lower.
+    std::atomic<uint32_t>                                 mEnqueuedGroupCount;  // Written by the producer task.
+    std::atomic<uint32_t>                                 mSampleHead;          // Written by the producer task.
+    std::atomic<uint32_t>                                 mSampleTail;          // Written by the transmitter.
+  };
+
+  struct alignas(csCacheLineSize) TransmitterCounters final {
+    std::atomic<uint64_t> mPoppedCount;
+    std::atomic<uint64_t> mSendCount;
+    std::atomic<uint64_t> mBytesSent;
+    std::atomic<uint64_t> mDiscardedGroupCount;
+    std::atomic<uint64_t> mSequenceGapCount;
+    std::atomic<uint64_t> mPoolExhaustedCount;
+    std::atomic<uint64_t> mOverQuotaCount;
+    std::atomic<uint64_t> mQueueHighWatermark;
+    std::atomic<uint64_t> mPoolHighWatermark;
+  };
+
+  using AtomicHistogram = std::array<std::atomic<uint64_t>, csBucketCount>;
+
+  /// Message and byte counts have the transmitter as single writer, drops come from producers as well.
+  struct AtomicVolume final {
+    std::atomic<uint64_t> mMessageCount;
+    std::atomic<uint64_t> mByteCount;
+    std::atomic<uint64_t> mDroppedCount;
+    std::atomic<uint64_t> mOverQuotaCount;
+  };
+
+  static constexpr uint8_t csReportBase = 10u;
+  static constexpr uint8_t csReportFill = 0u;
+
+  inline static std::array<Shard, tShardCount>           sShards;
+  inline static std::array<TaskLatency, csTaskSlotCount> sTaskLatencies;
+  inline static TransmitterCounters                      sCounters;
+  inline static AtomicHistogram                          sQueueWaitHistogram;
+  inline static AtomicHistogram                          sConvertHistogram;
+  inline static AtomicHistogram                          sSendHistogram;
+  inline static AtomicHistogram                          sLatencyHistogram;
+  inline static std::array<AtomicVolume, csTopicSlotCount> sTopicVolumes;
+  inline static std::array<AtomicVolume, csTaskSlotCount>  sTaskVolumes;
+  inline static std::array<uint32_t, csTaskSlotCount>    sArrivedGroupCounts;   // Transmitter only.
+  inline static thread_local bool                        shSampling;            // Between groupStarting and groupPushed.
+  inline static uint64_t                                 sPoolUsed;             // Transmitter only.
+  inline static PerformanceTime                          sCurrentStart;         // Transmitter only.
+  inline static bool                                     sCurrentStartValid;    // Transmitter only.
+  inline static PerformanceTime                          sConvertStart;         // Transmitter only.
+  inline static PerformanceTime                          sSendStart;            // Transmitter only.
+
+  StatisticsAtomic() = delete;
+
+public:
+  static void pushed(TaskId const aTaskId, bool const aSuccess) noexcept {
+    Shard &shard = sShards[aTaskId % tShardCount];
+    if(aSuccess) {
+      shard.mPushedCount.fetch_add(1u, std::memory_order_relaxed);
+    }
+    else {
+      shard.mPushFailedCount.fetch_add(1u, std::memory_order_relaxed);
+    }
+  }
+
+  /// Called before pushing the message completing the group.
+  static void groupStarting(TaskId const aTaskId) noexcept {
+    shSampling = false;
+    if(aTaskId != csIsrTaskId) {
+      TaskLatency &task = sTaskLatencies[aTaskId];
+      uint32_t const head = task.mSampleHead.load(std::memory_order_relaxed);
+      if(head - task.mSampleTail.load(std::memory_order_acquire) < csLatencySlotCount) {
+        uint32_t const index = task.mEnqueuedGroupCount.load(std::memory_order_relaxed);
+        task.mSlots[head % csLatencySlotCount].store((static_cast<uint64_t>(index) << csIndexShift) | tAppInterface::getPerformanceTime(), std::memory_order_relaxed);
+        shSampling = true;
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  /// Publishes the sample only if the group made it into the queue.
+  static void groupPushed(TaskId const aTaskId, bool const aSuccess) noexcept {
+    if(aTaskId != csIsrTaskId && aSuccess) {
+      TaskLatency &task = sTaskLatencies[aTaskId];
+      task.mEnqueuedGroupCount.store(task.mEnqueuedGroupCount.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+      if(shSampling) {
+        task.mSampleHead.store(task.mSampleHead.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void popped() noexcept {
+    uint64_t const popped = add(sCounters.mPoppedCount, 1u);
+    uint64_t pushed = 0u;
+    for(auto const &shard : sShards) {
+      pushed += shard.mPushedCount.load(std::memory_order_relaxed);
+    }
+    raise(sCounters.mQueueHighWatermark, pushed + 1u > popped ? pushed + 1u - popped : 0u);  // The popped one was in the queue as well.
+  }
+
+  /// Called when the message completing a group of the task arrives, even if the group turns out to be incomplete.
+  static void groupArrived(TaskId const aTaskId) noexcept {
+    sCurrentStartValid = false;
+    if(aTaskId != csIsrTaskId) {
+      TaskLatency &task = sTaskLatencies[aTaskId];
+      uint32_t const index = sArrivedGroupCounts[aTaskId]++;
+      uint32_t const tail = task.mSampleTail.load(std::memory_order_relaxed);
+      if(tail != task.mSampleHead.load(std::memory_order_acquire)) {
+        uint64_t const slot = task.mSlots[tail % csLatencySlotCount].load(std::memory_order_relaxed);
+        if(static_cast<uint32_t>(slot >> csIndexShift) == index) {
+          sCurrentStart = static_cast<PerformanceTime>(slot);
+          sCurrentStartValid = true;
+          task.mSampleTail.store(tail + 1u, std::memory_order_release);
+        }
+        else { // The sample belongs to a later group, nothing to do
+        }
+      }
+      else { // nothing to do
+      }
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void convertStarting() noexcept {
+    sConvertStart = tAppInterface::getPerformanceTime();
+    if(sCurrentStartValid) {
+      record(sQueueWaitHistogram, sConvertStart - sCurrentStart);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void sendStarting() noexcept {
+    sSendStart = tAppInterface::getPerformanceTime();
+    record(sConvertHistogram, sSendStart - sConvertStart);
+    if(sCurrentStartValid) {
+      record(sLatencyHistogram, sSendStart - sCurrentStart);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void groupTransmitted(TaskId const aTaskId, LogTopic const aTopic, size_t const aMessageCount, size_t const aByteCount) noexcept {
+    record(sSendHistogram, tAppInterface::getPerformanceTime() - sSendStart);
+    sCurrentStartValid = false;
+    add(sTopicVolumes[getTopicIndex(aTopic)], aMessageCount, aByteCount);
+    add(sTaskVolumes[aTaskId], aMessageCount, aByteCount);
+  }
+
+  /// Called by producers for messages not fitting in the queue, and by the transmitter for messages it throws away.
+  static void dropped(TaskId const aTaskId, LogTopic const aTopic, size_t const aMessageCount) noexcept {
+    sTopicVolumes[getTopicIndex(aTopic)].mDroppedCount.fetch_add(aMessageCount, std::memory_order_relaxed);
+    sTaskVolumes[aTaskId].mDroppedCount.fetch_add(aMessageCount, std::memory_order_relaxed);
+  }
+
+  /// In direct mode several tasks may call it, serialized by tAppInterface::lock().
+  static void sent(size_t const aByteCount) noexcept {
+    sCounters.mSendCount.fetch_add(1u, std::memory_order_relaxed);
+    sCounters.mBytesSent.fetch_add(aByteCount, std::memory_order_relaxed);
+  }
+
+  static void poolAcquired() noexcept {
+    ++sPoolUsed;
+    raise(sCounters.mPoolHighWatermark, sPoolUsed);
+  }
+
+  static void poolReleased(size_t const aCount) noexcept {
+    sPoolUsed -= aCount;
+  }
+
+  static void poolExhausted() noexcept {
+    add(sCounters.mPoolExhaustedCount, 1u);
+  }
+
+  static void quotaExceeded(TaskId const aTaskId, LogTopic const aTopic) noexcept {
+    add(sCounters.mOverQuotaCount, 1u);
+    add(sTopicVolumes[getTopicIndex(aTopic)].mOverQuotaCount, 1u);
+    add(sTaskVolumes[aTaskId].mOverQuotaCount, 1u);
+  }
+
+  static void sequenceGap() noexcept {
+    add(sCounters.mSequenceGapCount, 1u);
+  }
+
+  static void groupDiscarded() noexcept {
+    add(sCounters.mDiscardedGroupCount, 1u);
+  }
+
+  /// Called by the transmitter processing the shutdown of the task, before its ID can be reused.
+  static void taskReleased(TaskId const aTaskId) noexcept {
+    TaskLatency &task = sTaskLatencies[aTaskId];
+    sArrivedGroupCounts[aTaskId] = 0u;
+    task.mEnqueuedGroupCount.store(0u, std::memory_order_relaxed);
+    task.mSampleHead.store(0u, std::memory_order_relaxed);
+    task.mSampleTail.store(0u, std::memory_order_relaxed);
+  }
+
+  static Snapshot getSnapshot() noexcept {
+    Snapshot result;
+    for(auto const &shard : sShards) {
+      result.pushedCount += shard.mPushedCount.load(std::memory_order_relaxed);
+      result.pushFailedCount += shard.mPushFailedCount.load(std::memory_order_relaxed);
+    }
+    result.poppedCount = sCounters.mPoppedCount.load(std::memory_order_relaxed);
+    result.sendCount = sCounters.mSendCount.load(std::memory_order_relaxed);
+    result.bytesSent = sCounters.mBytesSent.load(std::memory_order_relaxed);
+    result.discardedGroupCount = sCounters.mDiscardedGroupCount.load(std::memory_order_relaxed);
+    result.sequenceGapCount = sCounters.mSequenceGapCount.load(std::memory_order_relaxed);
+    result.poolExhaustedCount = sCounters.mPoolExhaustedCount.load(std::memory_order_relaxed);
+    result.overQuotaCount = sCounters.mOverQuotaCount.load(std::memory_order_relaxed);
+    result.queueHighWatermark = sCounters.mQueueHighWatermark.load(std::memory_order_relaxed);
+    result.poolHighWatermark = sCounters.mPoolHighWatermark.load(std::memory_order_relaxed);
+    load(result.queueWaitHistogram, sQueueWaitHistogram);
+    load(result.convertHistogram, sConvertHistogram);
+    load(result.sendHistogram, sSendHistogram);
+    load(result.latencyHistogram, sLatencyHistogram);
+    for(size_t i = 0u; i < csTopicSlotCount; ++i) {
+      result.topicVolumes[i] = load(sTopicVolumes[i]);
+    }
+    for(size_t i = 0u; i < csTaskSlotCount; ++i) {
+      result.taskVolumes[i] = load(sTaskVolumes[i]);
+    }
+    return result;
+  }
+
+  /// Cheaper than a whole snapshot when looking for a single topic. csInvalidTopic gives the untopiced ones.
+  static Volume getTopicVolume(LogTopic const aTopic) noexcept {
+    return load(sTopicVolumes[getTopicIndex(aTopic)]);
+  }
+
+  /// Task IDs are reused after unregistration, so this accumulates all tasks having had the ID.
+  static Volume getTaskVolume(TaskId const aTaskId) noexcept {
+    return load(sTaskVolumes[aTaskId]);
+  }
+
+  static constexpr size_t getTopicIndex(LogTopic const aTopic) noexcept {
+    return aTopic >= 0 && aTopic < tMaxTopicCount ? static_cast<size_t>(aTopic) : static_cast<size_t>(tMaxTopicCount);
+  }
+
+  static constexpr size_t getBucketIndex(PerformanceTime const aValue) noexcept {
+    size_t result;
+    if(aValue < csSubBucketCount) {
+      result = aValue;
+    }
+    else {
+      uint32_t const shift = std::bit_width(aValue) - 1u - csSubBucketBits;
+      result = csSubBucketCount + shift * csSubBucketCount + ((aValue >> shift) & (csSubBucketCount - 1u));
+    }
+    return result;
+  }
+
+  static constexpr PerformanceTime getBucketLowerBound(size_t const aIndex) noexcept {
+    PerformanceTime result;
+    if(aIndex < csSubBucketCount) {
+      result = aIndex;
+    }
+    else {
+      size_t const shift = (aIndex - csSubBucketCount) / csSubBucketCount;
+      result = static_cast<PerformanceTime>((csSubBucketCount + (aIndex - csSubBucketCount) % csSubBucketCount) << shift);
+    }
+    return result;
+  }
+
+  static constexpr PerformanceTime getBucketUpperBound(size_t const aIndex) noexcept {
+    return aIndex + 1u < csBucketCount ? getBucketLowerBound(aIndex + 1u) - 1u : std::numeric_limits<PerformanceTime>::max();
+  }
+
+  /// Upper bound of the bucket containing the given per mille of the samples, 0 without samples.
+  static PerformanceTime getPercentile(Histogram const &aHistogram, uint32_t const aPerMille) noexcept {
+    uint64_t total = 0u;
+    for(auto const count : aHistogram) {
+      total += count;
+    }
+    uint64_t const wanted = (total * aPerMille + csPerMille - 1u) / csPerMille;
+    uint64_t seen = 0u;
+    PerformanceTime result = 0u;
+    for(size_t i = 0u; i < csBucketCount && total > 0u; ++i) {
+      seen += aHistogram[i];
+      if(seen >= wanted && aHistogram[i] > 0u) {
+        result = getBucketUpperBound(i);
+        break;
+      }
+      else { // nothing to do
+      }
+    }
+    return result;
+  }
+
+  /// Converts line aLine of the self-report, which Log sends periodically if asked.
+  template<typename tConverter>
+  static void outputReportLine(tConverter &aConverter, Snapshot const &aSnapshot, size_t const aLine) noexcept {
+    if(aLine == 0u) {
+      convert(aConverter, csLabelPushed, aSnapshot.pushedCount);
+      convert(aConverter, csLabelPushFailed, aSnapshot.pushFailedCount);
+      convert(aConverter, csLabelPopped, aSnapshot.poppedCount);
+      convert(aConverter, csLabelQueueMax, aSnapshot.queueHighWatermark);
+    }
+    else if(aLine == 1u) {
+      convert(aConverter, csLabelSent, aSnapshot.sendCount);
+      convert(aConverter, csLabelBytes, aSnapshot.bytesSent);
+      convert(aConverter, csLabelDiscarded, aSnapshot.discardedGroupCount);
+      convert(aConverter, csLabelGaps, aSnapshot.sequenceGapCount);
+      convert(aConverter, csLabelExhausted, aSnapshot.poolExhaustedCount);
+      convert(aConverter, csLabelOverQuota, aSnapshot.overQuotaCount);
+      convert(aConverter, csLabelPoolMax, aSnapshot.poolHighWatermark);
+    }
+    else if(aLine == 2u) {
+      convert(aConverter, csLabelQueueWait, aSnapshot.queueWaitHistogram);
+    }
+    else if(aLine == 3u) {
+      convert(aConverter, csLabelConvert, aSnapshot.convertHistogram);
+    }
+    else if(aLine == 4u) {
+      convert(aConverter, csLabelSend, aSnapshot.sendHistogram);
+    }
+    else {
+      convert(aConverter, csLabelLatency, aSnapshot.latencyHistogram);
+    }
+  }
+
+private:
+  static constexpr uint32_t csPerMille = 1000u;
+  static constexpr uint32_t csP50      = 500u;
+  static constexpr uint32_t csP90      = 900u;
+  static constexpr uint32_t csP99      = 990u;
+  static constexpr uint32_t csMax      = csPerMille;
+
+  inline static constexpr char csLabelPushed[]     = "pushed:";
+  inline static constexpr char csLabelPushFailed[] = "failed:";
+  inline static constexpr char csLabelPopped[]     = "popped:";
+  inline static constexpr char csLabelQueueMax[]   = "queue max:";
+  inline static constexpr char csLabelSent[]       = "sent:";
+  inline static constexpr char csLabelBytes[]      = "bytes:";
+  inline static constexpr char csLabelDiscarded[]  = "discarded:";
+  inline static constexpr char csLabelGaps[]       = "gaps:";
+  inline static constexpr char csLabelExhausted[]  = "pool exhausted:";
+  inline static constexpr char csLabelOverQuota[]  = "over quota:";
+  inline static constexpr char csLabelPoolMax[]    = "pool max:";
+  inline static constexpr char csLabelQueueWait[]  = "queue wait us";
+  inline static constexpr char csLabelConvert[]    = "convert us";
+  inline static constexpr char csLabelSend[]       = "send us";
+  inline static constexpr char csLabelLatency[]    = "latency us";
+  inline static constexpr char csLabelP50[]        = "p50:";
+  inline static constexpr char csLabelP90[]        = "p90:";
+  inline static constexpr char csLabelP99[]        = "p99:";
+  inline static constexpr char csLabelMax[]        = "max:";
+
+  template<typename tConverter>
+  static void convert(tConverter &aConverter, char const * const aLabel, uint64_t const aValue) noexcept {
+    aConverter.convert(aLabel, csReportBase, csReportFill);
+    aConverter.convert(aValue, csReportBase, csReportFill);
+  }
+
+  template<typename tConverter>
+  static void convert(tConverter &aConverter, char const * const aLabel, Histogram const &aHistogram) noexcept {
+    aConverter.convert(aLabel, csReportBase, csReportFill);
+    convert(aConverter, csLabelP50, getPercentile(aHistogram, csP50));
+    convert(aConverter, csLabelP90, getPercentile(aHistogram, csP90));
+    convert(aConverter, csLabelP99, getPercentile(aHistogram, csP99));
+    convert(aConverter, csLabelMax, getPercentile(aHistogram, csMax));
+  }
+
+  /// Single writer.
+  static void record(AtomicHistogram &aHistogram, PerformanceTime const aValue) noexcept {
+    add(aHistogram[getBucketIndex(aValue)], 1u);
+  }
+
+  /// Single writer.
+  static void add(AtomicVolume &aVolume, size_t const aMessageCount, size_t const aByteCount) noexcept {
+    add(aVolume.mMessageCount, aMessageCount);
+    add(aVolume.mByteCount, aByteCount);
+  }
+
+  static Volume load(AtomicVolume const &aVolume) noexcept {
+    Volume result;
+    result.messageCount = aVolume.mMessageCount.load(std::memory_order_relaxed);
+    result.byteCount = aVolume.mByteCount.load(std::memory_order_relaxed);
+    result.droppedCount = aVolume.mDroppedCount.load(std::memory_order_relaxed);
+    result.overQuotaCount = aVolume.mOverQuotaCount.load(std::memory_order_relaxed);
+    return result;
+  }
+
+  static void load(Histogram &aResult, AtomicHistogram const &aHistogram) noexcept {
+    for(size_t i = 0u; i < csBucketCount; ++i) {
+      aResult[i] = aHistogram[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  /// Single writer, so no read-modify-write is needed.
+  static uint64_t add(std::atomic<uint64_t> &aCounter, uint64_t const aValue) noexcept {
+    uint64_t const result = aCounter.load(std::memory_order_relaxed) + aValue;
+    aCounter.store(result, std::memory_order_relaxed);
+    return result;
+  }
+
+  static void raise(std::atomic<uint64_t> &aWatermark, uint64_t const aValue) noexcept {
+    if(aValue > aWatermark.load(std::memory_order_relaxed)) {
+      aWatermark.store(aValue, std::memory_order_relaxed);
+    }
+    else { // nothing to do
+    }
+  }
+};
+
+}
+
+#endif
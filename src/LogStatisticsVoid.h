@@ -0,0 +1,80 @@
+#ifndef NOWTECH_LOG_STATISTICS_VOID
+#define NOWTECH_LOG_STATISTICS_VOID
+
+#include "LogMessageBase.h"
+#include <cstddef>
+
+namespace nowtech::log {
+
+/// Default statistics implementation collecting nothing. All calls compile
+/// away, so Log costs the same as without statistics.
+class StatisticsVoid final {
+public:
+  static constexpr bool csEnabled = false;
+
+  struct Snapshot final {
+  };
+
+private:
+  StatisticsVoid() = delete;
+
+public:
+  static void pushed(TaskId const, bool const) noexcept { // nothing to do
+  }
+
+  static void groupStarting(TaskId const) noexcept { // nothing to do
+  }
+
+  static void groupPushed(TaskId const, bool const) noexcept { // nothing to do
+  }
+
+  static void popped() noexcept { // nothing to do
+  }
+
+  static void groupArrived(TaskId const) noexcept { // nothing to do
+  }
+
+  static void convertStarting() noexcept { // nothing to do
+  }
+
+  static void sendStarting() noexcept { // nothing to do
+  }
+
+  static void groupTransmitted(TaskId const, LogTopic const, size_t const, size_t const) noexcept { // nothing to do
+  }
+
+  static void dropped(TaskId const, LogTopic const, size_t const) noexcept { // nothing to do
+  }
+
+  static void sent(size_t const) noexcept { // nothing to do
+  }
+
+  static void poolAcquired() noexcept { // nothing to do
+  }
+
+  static void poolReleased(size_t const) noexcept { // nothing to do
+  }
+
+  static void poolExhausted() noexcept { // nothing to do
+  }
+
+  static void quotaExceeded(TaskId const, LogTopic const) noexcept { // nothing to do
+  }
+
+  static void sequenceGap() noexcept { // nothing to do
+  }
+
+  static void groupDiscarded() noexcept { // nothing to do
+  }
+
+  static void taskReleased(TaskId const) noexcept { // nothing to do
+  }
+
+  static Snapshot getSnapshot() noexcept {
+    return Snapshot{};
+  }
+};
+
+}
+
+#endif
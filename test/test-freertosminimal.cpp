@@ -21,6 +21,9 @@
  * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
  */
 
+// Only short groups here, so a byte per message is saved.
+#define NOWTECH_LOG_MESSAGE_SEQUENCE_BITS 8
+
 #include "LogAppInterfaceFreeRtosMinimal.h"
 #include "LogConverterCustomText.h"
 #include "LogSenderStmHalMinimal.h"
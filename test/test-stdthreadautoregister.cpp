@@ -0,0 +1,125 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <pthread.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadautoregister.cpp -lpthread -o test-stdthreadautoregister
+// Threads of a "third-party pool" log without registering. There are more of them in total than task IDs.
+
+constexpr size_t cgWaveCount = 5;
+constexpr size_t cgThreadsPerWave = 6;
+constexpr int32_t cgLinesPerThread = 5;
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadsPerWave + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgAutoRegister = true;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 1024u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadautoregister.log";
+constexpr char cgPoolPrefix[] = "pool_";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod, cgAutoRegister>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+// Knows nothing about the logger apart from logging.
+void poolWorker(size_t n) {
+  std::string name = cgPoolPrefix + std::to_string(n);
+  pthread_setname_np(pthread_self(), name.c_str());
+  for(int32_t i = 0; i < cgLinesPerThread; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "item:" << i << Log::end;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+int main() {
+  std::thread threads[cgThreadsPerWave];
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  for(size_t wave = 0; wave < cgWaveCount; ++wave) {
+    for(size_t i = 0; i < cgThreadsPerWave; ++i) {
+      threads[i] = std::thread(poolWorker, wave * cgThreadsPerWave + i);
+    }
+    for(size_t i = 0; i < cgThreadsPerWave; ++i) {
+      threads[i].join();
+    }
+    // The IDs of the exited threads are free again once the transmitter has processed their messages.
+    std::this_thread::sleep_for(std::chrono::milliseconds(cgRefreshPeriod));
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  size_t lineCount = 0u;
+  size_t namedCount = 0u;
+  while(std::getline(in, line)) {
+    ++lineCount;
+    namedCount += (line.find(cgPoolPrefix) == 0u ? 1u : 0u);
+  }
+  size_t const expected = cgWaveCount * cgThreadsPerWave * cgLinesPerThread;
+  std::cout << "expected lines: " << expected << ", logged: " << lineCount << ", with thread name: " << namedCount << std::endl;
+  return lineCount == expected && namedCount == expected ? 0 : 1;
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderCoalescing.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <algorithm>
+#include <unistd.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadcoalescing.cpp -lpthread -o test-stdthreadcoalescing
+// Writes to stdout through a sender counting the send() calls reaching it, and checks
+// that all lines arrived in much fewer calls than the number of lines. The
+// registration notices are lines too, so there are more lines than logged items.
+
+constexpr size_t cgThreadCount = 4;
+constexpr int32_t cgLinesPerThread = 100;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgCoalesceBufferSize = 4096u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 444u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 20u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+
+/// Writes to a file descriptor and counts the calls and the lines.
+class SenderCounting final {
+public:
+  using tAppInterface_   = LogAppInterfaceStd;
+  using tConverter_      = LogConverterCustomText;
+  using ConversionResult = char;
+  using Iterator         = char*;
+
+  static constexpr bool csVoid = false;
+
+  inline static size_t sSendCount = 0u;
+  inline static size_t sLineCount = 0u;
+  inline static bool   sInitialized = false;
+  inline static bool   sDone = false;
+
+private:
+  inline static int sFd;
+
+public:
+  static void init(int const aFd) noexcept {
+    sFd = aFd;
+    sInitialized = true;
+  }
+
+  static void done() noexcept {
+    sDone = true;
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) {
+    ++sSendCount;
+    sLineCount += std::count(aBegin, aEnd, '\n');
+    size_t const length = aEnd - aBegin;
+    if(::write(sFd, aBegin, length) != static_cast<ssize_t>(length)) {
+      LogAppInterfaceStd::error(nowtech::log::Exception::cSenderError);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void flush() noexcept { // nothing to do
+  }
+
+  static auto getBuffer() {
+    return std::pair(static_cast<Iterator>(nullptr), static_cast<Iterator>(nullptr));
+  }
+};
+
+using LogSender = nowtech::log::SenderCoalescing<SenderCounting, cgTransmitBufferSize, cgCoalesceBufferSize, cgTimeout>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSender, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void periodicLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLinesPerThread; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "periodic item:" << i << Log::end;
+    if(i % 10 == 9) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  LogSender::init(STDOUT_FILENO);
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(periodicLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  size_t const expected = cgThreadCount * cgLinesPerThread;
+  std::printf("\nlines: %zu of %zu in %zu send() calls, wrapped sender initialized: %d, done: %d\n",
+              SenderCounting::sLineCount, expected, SenderCounting::sSendCount, SenderCounting::sInitialized, SenderCounting::sDone);
+  return SenderCounting::sInitialized && SenderCounting::sDone && SenderCounting::sLineCount >= expected && SenderCounting::sSendCount < expected / 2u ? 0 : 1;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadconcurrentgroups.cpp -lpthread -o test-stdthreadconcurrentgroups
+
+constexpr nowtech::log::TaskId cgThreadCount = 4;
+constexpr uint32_t cgIterationCount = 200u;
+constexpr uint32_t cgPausePeriod = 20u;
+constexpr uint32_t cgGroupSlotCount = 8u;
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 8192u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadconcurrentgroups.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+using LogHelper = decltype(Log::i());
+
+uint32_t logged(uint32_t const aValue) {
+  Log::i() << "inner:" << aValue << Log::end;
+  return aValue;
+}
+
+void interleave() {
+  Log::registerCurrentTask("worker");
+  for(uint32_t i = 0u; i < cgIterationCount; ++i) {
+    auto a = Log::i() << "a:" << i;
+    auto b = Log::i() << "b:" << i;
+    a << "a";
+    b << "b";
+    a << Log::end;
+    b << Log::end;
+    if(i % cgPausePeriod == 0u) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  Log::init(logConfig);
+  Log::registerCurrentTask("main");
+
+  Log::i() << "outer:" << logged(1u) << Log::end;
+  {
+    std::vector<LogHelper> helpers;
+    helpers.reserve(cgGroupSlotCount + 1u);
+    for(uint32_t i = 0u; i <= cgGroupSlotCount; ++i) {
+      helpers.emplace_back(Log::i() << "slot:");
+    }
+    for(uint32_t i = 0u; i <= cgGroupSlotCount; ++i) {
+      helpers[i] << i;
+    }
+  }   // The destructors end the groups, the one beyond the slots got dropped.
+
+  std::thread threads[cgThreadCount];
+  for(nowtech::log::TaskId i = 0u; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(interleave);
+  }
+  for(nowtech::log::TaskId i = 0u; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  uint32_t innerCount = 0u;
+  uint32_t outerCount = 0u;
+  uint32_t slotCount = 0u;
+  uint32_t aCount = 0u;
+  uint32_t bCount = 0u;
+  uint32_t badCount = 0u;
+  while(std::getline(in, line)) {
+    if(line.find("main") == 0u && line.find("inner: 1 ") != std::string::npos) {
+      ++innerCount;
+    }
+    else if(line.find("main") == 0u && line.find("outer: 1 ") != std::string::npos) {
+      ++outerCount;
+    }
+    else if(line.find("main") == 0u && line.find("slot: ") != std::string::npos) {
+      ++slotCount;
+    }
+    else if(line.find("worker") == 0u && line.find(" a: ") != std::string::npos && line.rfind(" a ") == line.size() - 3u) {
+      ++aCount;
+    }
+    else if(line.find("worker") == 0u && line.find(" b: ") != std::string::npos && line.rfind(" b ") == line.size() - 3u) {
+      ++bCount;
+    }
+    else {
+      std::cout << "bad line: " << line << std::endl;
+      ++badCount;
+    }
+  }
+  std::cout << "inner: " << innerCount << " outer: " << outerCount << " slot: " << slotCount << " a: " << aCount << " b: " << bCount << " bad: " << badCount << std::endl;
+  bool const consistent = innerCount == 1u && outerCount == 1u && slotCount == cgGroupSlotCount
+                       && aCount == cgThreadCount * cgIterationCount && bCount == cgThreadCount * cgIterationCount && badCount == 0u;
+  std::cout << "consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
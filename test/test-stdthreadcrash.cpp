@@ -0,0 +1,184 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadcrash.cpp -lpthread -o test-stdthreadcrash
+// A child process logs and then crashes, once while the transmitter is
+// busy and once while it is idle. The parent checks if the lines sent
+// normally and the ones drained on the fatal signal contain all.
+
+constexpr size_t cgThreadCount = 2;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 8192u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr int32_t cgLineCount = 300;
+constexpr size_t cgWarmUpPeriod = 200u;
+constexpr size_t cgIdlePeriod = 300u;
+constexpr char cgNormalFileName[] = "test-stdthreadcrash-normal.log";
+constexpr char cgEmergencyFileName[] = "test-stdthreadcrash-emergency.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderStdOstream, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+std::atomic<size_t> gFinishedCount = 0u;
+
+int crash() {
+  volatile int *nowhere = nullptr;
+  return *nowhere;
+}
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  // The drain does not allocate, so the transmitter must have seen the task before.
+  Log::i(nowtech::LogTopics::system) << "warm-up" << Log::end;
+  std::this_thread::sleep_for(std::chrono::milliseconds(cgWarmUpPeriod));
+  for(int32_t i = 0; i < cgLineCount; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "burst item:" << i << Log::end;
+  }
+  ++gFinishedCount;
+  // Never unregisters, the process crashes meanwhile.
+  while(true) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(cgTaskShutdownSleepPeriod));
+  }
+}
+
+void child(bool const aIdle) {
+  // Unbuffered, so the normal output is not lost in the crash.
+  std::ofstream normal;
+  normal.rdbuf()->pubsetbuf(nullptr, 0);
+  normal.open(cgNormalFileName);
+  int emergencyFd = ::open(cgEmergencyFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  LogSenderStdOstream::init(&normal);
+
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  LogAppInterfaceStd::installFatalSignalHandlers(emergencyFd, Log::emergencyDrain);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+  Log::i(nowtech::LogTopics::system) << "warm-up" << Log::end;
+
+  std::thread threads[cgThreadCount];
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  while(gFinishedCount < cgThreadCount) {
+    std::this_thread::yield();
+  }
+  for(int32_t i = 0; i < cgLineCount; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(cgThreadCount) << "burst item:" << i << Log::end;
+  }
+  if(aIdle) { // The transmitter waits in the queue when the crash happens.
+    std::this_thread::sleep_for(std::chrono::milliseconds(cgIdlePeriod));
+  }
+  else { // nothing to do
+  }
+  Log::i(nowtech::LogTopics::system) << "partial" << "line" << crash() << Log::end;
+}
+
+bool contains(std::string const &aText, std::string const &aWhat) {
+  return aText.find(aWhat) != std::string::npos;
+}
+
+std::string read(char const * const aFileName) {
+  std::ifstream in(aFileName);
+  std::stringstream content;
+  content << in.rdbuf();
+  return content.str();
+}
+
+bool check(bool const aIdle) {
+  pid_t pid = ::fork();
+  if(pid == 0) {
+    child(aIdle);
+    std::exit(0);
+  }
+  else { // nothing to do
+  }
+  int status;
+  ::waitpid(pid, &status, 0);
+  bool ok = WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV;
+  std::string normal = read(cgNormalFileName);
+  std::string emergency = read(cgEmergencyFileName);
+  std::string all = normal + emergency;
+  for(size_t n = 0; n <= cgThreadCount; ++n) {
+    for(int32_t i = 0; i < cgLineCount; ++i) {
+      std::string line = "system " + std::to_string(n) + " burst item: " + std::to_string(i) + " \n";
+      ok = ok && contains(all, line);
+    }
+  }
+  ok = ok && contains(emergency, "line \n") && contains(emergency, "-=- Truncated group of task:");
+  std::cout << (aIdle ? "idle" : "busy") << " transmitter, normal lines: " << std::count(normal.begin(), normal.end(), '\n')
+            << ", drained lines: " << std::count(emergency.begin(), emergency.end(), '\n')
+            << (ok ? ", PASSED" : ", FAILED") << std::endl;
+  return ok;
+}
+
+int main() {
+  bool const busy = check(false);
+  bool const idle = check(true);
+  return busy && idle ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreaddeduplicate.cpp -lpthread -o test-stdthreaddeduplicate
+
+constexpr size_t cgThreadCount = 3;
+constexpr int32_t cgLinesPerThread = 20000;
+constexpr int32_t cgChangePeriod = 5000;
+constexpr int32_t cgPausePeriod = 10;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 16384u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreaddeduplicate.log";
+constexpr uint32_t cgSuppressionReportPeriod = 20u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+// Each thread repeats the same error, which changes now and then.
+void errorStorm(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLinesPerThread; ++i) {
+    Log::i(nowtech::LogTopics::system) << "connection failed, error:" << i / cgChangePeriod << Log::end;
+    if(i % cgPausePeriod == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  logConfig.deduplicate = true;
+  logConfig.suppressionReportPeriod = cgSuppressionReportPeriod;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(errorStorm, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::done();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  uint64_t lineCount = 0u;
+  uint64_t sentCount = 0u;
+  uint64_t repeatedCount = 0u;
+  while(std::getline(in, line)) {
+    ++lineCount;
+    auto const position = line.find(" repeated ");
+    if(position != std::string::npos) {
+      repeatedCount += std::stoull(line.substr(position + 10u));
+    }
+    else if(line.find("connection failed") != std::string::npos) {
+      ++sentCount;
+    }
+    else { // nothing to do
+    }
+  }
+  // The queue may overflow, so some lines may be lost.
+  uint64_t const total = cgThreadCount * cgLinesPerThread;
+  std::cout << "lines in file: " << lineCount << ", sent: " << sentCount << ", repeated: " << repeatedCount << ", logged: " << total << std::endl;
+  bool const consistent = sentCount + repeatedCount <= total
+                       && sentCount >= cgThreadCount * (cgLinesPerThread / cgChangePeriod)
+                       && repeatedCount > 0u
+                       && lineCount * 10u < total;
+  std::cout << "consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
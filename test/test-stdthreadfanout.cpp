@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFanOut.h"
+#include "LogSenderFile.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadfanout.cpp -lpthread -o test-stdthreadfanout
+
+constexpr size_t cgThreadCount = 3;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+  nowtech::log::TopicInstance alert;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgSinkBufferSize = 16u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr bool cgStoreTopic = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr size_t cgFileSinkIndex = 0u;
+constexpr size_t cgConsoleSinkIndex = 1u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint, cgStoreTopic>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogSenderFanOut = nowtech::log::SenderFanOut<cgTransmitBufferSize, cgSinkBufferSize, LogSenderFile, LogSenderStdOstream>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFanOut, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < 1000; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "burst item:" << i << Log::end;
+    if(i % 250 == 0) {
+      Log::i(nowtech::LogTopics::alert) << static_cast<uint16_t>(n) << "reached:" << i << Log::end;
+    }
+    else { // nothing to do
+    }
+    if(i % 10 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = "test-stdthreadfanout.log";
+  LogSenderFile::init(senderConfig);
+  LogSenderStdOstream::init(&std::cout);
+  LogSenderFanOut::init();
+
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerTopic(nowtech::LogTopics::alert, "alert");
+  LogSenderFanOut::setAllTopicsEnabled(cgConsoleSinkIndex, false);
+  LogSenderFanOut::setTopicEnabled(cgConsoleSinkIndex, nowtech::LogTopics::alert, true);
+  Log::registerCurrentTask("main");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+  Log::n() << "dropped groups, file:" << LogSenderFanOut::getDroppedCount(cgFileSinkIndex) << "console:" << LogSenderFanOut::getDroppedCount(cgConsoleSinkIndex) << Log::end;
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  LogSenderStdOstream::done();
+  LogSenderFile::done();
+  return 0;
+}
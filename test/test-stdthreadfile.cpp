@@ -0,0 +1,179 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <array>
+#include <thread>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sys/stat.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadfile.cpp -lpthread -o test-stdthreadfile
+// Logs enough from several threads to rotate the file by size, then reads the
+// files back oldest first. Each thread's items must be there in order, each
+// line must be whole, and the rotated files must be full up to the last
+// batch, which did not fit.
+
+constexpr size_t cgThreadCount = 4;
+constexpr int32_t cgLineCount = 2000;
+constexpr size_t cgRotationSize = 256u * 1024u;
+constexpr uint8_t cgKeepCount = 3u;
+constexpr char cgLogFileName[] = "test-stdthreadfile.log";
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLineCount; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "burst item:" << i << Log::end;
+    if(i % 10 == 0) {   // Keeps the queue from overflowing while the file is synced.
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+std::string getFileName(uint8_t const aIndex) {
+  return aIndex == 0u ? std::string(cgLogFileName) : std::string(cgLogFileName) + '.' + std::to_string(aIndex);
+}
+
+size_t getFileSize(std::string const &aFileName) {
+  struct stat status;
+  return ::stat(aFileName.c_str(), &status) == 0 ? static_cast<size_t>(status.st_size) : 0u;
+}
+
+/// Reads the files oldest first and checks the burst items of each thread.
+bool check() {
+  std::array<int32_t, cgThreadCount> next;
+  next.fill(0);
+  bool ok = true;
+  uint8_t rotatedCount = 0u;
+  for(int32_t index = cgKeepCount; index >= 0; --index) {
+    std::string const fileName = getFileName(static_cast<uint8_t>(index));
+    std::ifstream in(fileName);
+    if(in.is_open()) {
+      size_t const size = getFileSize(fileName);
+      ok = ok && size <= cgRotationSize;
+      if(index > 0) {
+        ++rotatedCount;
+        ok = ok && size > cgRotationSize - cgWriteBufferSize;
+      }
+      else { // nothing to do
+      }
+      std::string line;
+      while(std::getline(in, line)) {
+        char const *item = std::strstr(line.c_str(), "system ");
+        unsigned thread;
+        int32_t value;
+        if(item != nullptr && std::sscanf(item, "system %u burst item: %d", &thread, &value) == 2) {
+          ok = ok && thread < cgThreadCount && value == next[thread];
+          next[thread] = value + 1;
+        }
+        else { // nothing to do
+        }
+      }
+      ok = ok && in.eof();
+    }
+    else { // nothing to do
+    }
+  }
+  for(auto const count : next) {
+    ok = ok && count == cgLineCount;
+  }
+  std::printf("rotated files: %u, %s\n", rotatedCount, ok ? "PASSED" : "FAILED");
+  return ok && rotatedCount > 0u;
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+  for(uint8_t i = 0u; i <= cgKeepCount; ++i) {
+    std::remove(getFileName(i).c_str());
+  }
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  senderConfig.rotationSize = cgRotationSize;
+  senderConfig.keepCount = cgKeepCount;
+  senderConfig.syncPeriod = 1000u;
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  return check() ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderIoUring.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstddef>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/prctl.h>
+#include <linux/filter.h>
+#include <linux/seccomp.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadiouring.cpp -lpthread -o test-stdthreadiouring
+// Logs to a file in three child processes: using io_uring, using the fallback
+// worker thread, and using io_uring that stops working. In the last case a
+// seccomp filter makes io_uring_enter fail after the ring was set up.
+// The parent checks that each file contains all items in order.
+
+constexpr size_t cgThreadCount = 4;
+constexpr int32_t cgLinesPerThread = 1000;
+char const * const cgModeNames[] = {"ring", "fallback", "failing ring"};
+char const * const cgFileNames[] = {"test-stdthreadiouring-ring.log", "test-stdthreadiouring-fallback.log", "test-stdthreadiouring-failing.log"};
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgBufferSize = 4096u;
+constexpr uint32_t cgBufferCount = 4u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 20u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderIoUring = nowtech::log::SenderIoUring<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgBufferSize, cgBufferCount>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderIoUring, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+enum class Mode : uint8_t {
+  cRing     = 0u,
+  cFallback = 1u,
+  cFailing  = 2u
+};
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLinesPerThread; ++i) {
+    Log::i(nowtech::LogTopics::system) << "item:" << i << "of" << static_cast<uint16_t>(n) << Log::end;
+    if(i % 10 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+/// Makes io_uring_enter fail with EPERM in this thread and in the ones it starts later.
+bool denyIoUringEnter() {
+  sock_filter filter[] = {
+    BPF_STMT(BPF_LD | BPF_W | BPF_ABS, offsetof(seccomp_data, nr)),
+    BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, __NR_io_uring_enter, 0, 1),
+    BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ERRNO | EPERM),
+    BPF_STMT(BPF_RET | BPF_K, SECCOMP_RET_ALLOW)
+  };
+  sock_fprog program = { static_cast<unsigned short>(sizeof(filter) / sizeof(filter[0])), filter };
+  return ::prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) == 0 && ::prctl(PR_SET_SECCOMP, SECCOMP_MODE_FILTER, &program) == 0;
+}
+
+/// The transmitter thread started by Log::init() inherits the seccomp filter.
+int child(Mode const aMode) {
+  int result = 0;
+  std::remove(cgFileNames[static_cast<size_t>(aMode)]);
+  LogSenderIoUring::init(cgFileNames[static_cast<size_t>(aMode)], aMode != Mode::cFallback);
+  bool const ringAtStart = LogSenderIoUring::isUsingIoUring();
+  if(aMode == Mode::cFailing && !denyIoUringEnter()) {
+    result = 1;
+  }
+  else { // nothing to do
+  }
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  std::thread threads[cgThreadCount];
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  bool const ringAtEnd = LogSenderIoUring::isUsingIoUring();
+  Log::done();
+  std::printf("%s: io_uring used at start: %d, at end: %d\n", cgModeNames[static_cast<size_t>(aMode)], ringAtStart, ringAtEnd);
+  if(aMode == Mode::cFallback && (ringAtStart || ringAtEnd)) {
+    result = 1;
+  }
+  else if(aMode == Mode::cFailing && ringAtEnd) {
+    result = 1;
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+/// Checks that all items of each thread are present in order.
+bool check(Mode const aMode) {
+  std::ifstream in(cgFileNames[static_cast<size_t>(aMode)]);
+  int32_t next[cgThreadCount] = {};
+  bool result = true;
+  std::string line;
+  while(std::getline(in, line)) {
+    char const *item = std::strstr(line.c_str(), "item:");
+    int32_t index;
+    int32_t thread;
+    if(item != nullptr && std::sscanf(item, "item: %d of %d", &index, &thread) == 2) {
+      if(thread >= 0 && static_cast<size_t>(thread) < cgThreadCount && next[thread] == index) {
+        ++next[thread];
+      }
+      else {
+        result = false;
+      }
+    }
+    else { // nothing to do
+    }
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    result = result && next[i] == cgLinesPerThread;
+  }
+  std::printf("%s: all items in order: %d\n", cgModeNames[static_cast<size_t>(aMode)], result);
+  std::remove(cgFileNames[static_cast<size_t>(aMode)]);
+  return result;
+}
+
+int main() {
+  bool ok = true;
+  for(Mode mode : {Mode::cRing, Mode::cFallback, Mode::cFailing}) {
+    std::fflush(stdout);
+    pid_t pid = ::fork();
+    if(pid == 0) {
+      return child(mode);
+    }
+    else { // nothing to do
+    }
+    int status;
+    ::waitpid(pid, &status, 0);
+    bool const checked = check(mode);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0 && checked;
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <csignal>
+#include <sys/time.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadisr.cpp -lpthread -o test-stdthreadisr
+// Logs from a signal driven timer while threads log under load. All ticks
+// and all thread lines must arrive whole and in order.
+
+constexpr size_t cgThreadCount = 3;
+constexpr int32_t cgLineCount = 1000;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+  nowtech::log::TopicInstance timer;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = true;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 8192u;
+constexpr size_t cgIsrQueueSize = 1024u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr suseconds_t cgTimerPeriodUs = 1000;
+constexpr char cgLogFileName[] = "test-stdthreadisr.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 10u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize, cgIsrQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+std::atomic<uint32_t> gTickCount = 0u;
+
+void timerHandler(int) {
+  LogAppInterfaceStd::IsrScope isr;
+  Log::i(nowtech::LogTopics::timer) << "tick" << gTickCount++ << Log::end;
+}
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLineCount; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "burst item:" << i << Log::end;
+    if(i % 10 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerTopic(nowtech::LogTopics::timer, "timer");
+  Log::registerCurrentTask("main");
+
+  struct sigaction action {};
+  action.sa_handler = timerHandler;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = SA_RESTART;
+  ::sigaction(SIGALRM, &action, nullptr);
+  itimerval period { { 0, cgTimerPeriodUs }, { 0, cgTimerPeriodUs } };
+  ::setitimer(ITIMER_REAL, &period, nullptr);
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  itimerval stop {};
+  ::setitimer(ITIMER_REAL, &stop, nullptr);
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  uint32_t tickLines = 0u;
+  std::array<int32_t, cgThreadCount> next;
+  next.fill(0);
+  bool ok = true;
+  while(std::getline(in, line)) {
+    uint32_t tick;
+    unsigned thread;
+    int32_t item;
+    if(line.rfind("ISR ", 0) == 0) {
+      ok = ok && std::sscanf(line.c_str(), "ISR %*u timer tick %u", &tick) == 1 && tick == tickLines;
+      ++tickLines;
+    }
+    else if(std::sscanf(line.c_str(), "thread_%*u %*u system %u burst item: %d", &thread, &item) == 2) {
+      ok = ok && thread < cgThreadCount && item == next[thread];
+      next[thread] = item + 1;
+    }
+    else { // nothing to do
+    }
+  }
+  for(auto const count : next) {
+    ok = ok && count == cgLineCount;
+  }
+  ok = ok && tickLines > 0u && tickLines == gTickCount;
+  std::cout << "ticks: " << gTickCount << ", logged: " << tickLines << (ok ? ", PASSED" : ", FAILED") << std::endl;
+  return ok ? 0 : 1;
+}
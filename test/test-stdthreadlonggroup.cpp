@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadlonggroup.cpp -lpthread -o test-stdthreadlonggroup
+
+constexpr uint16_t cgShortDumpLength = 500u;
+constexpr uint16_t cgLongDumpLength = 1000u;
+constexpr size_t cgItemLength = 7u;   // 0x1234 and a space
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = 2;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 2048u;
+constexpr uint32_t cgMaxGroupLength = 5000u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadlonggroup.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void dump(char const * const aName, uint16_t const aLength) {
+  auto logger = Log::i() << aName;
+  for(uint16_t i = 0u; i < aLength; ++i) {
+    logger << nowtech::log::LogConfig::X4 << i;
+  }
+  logger << Log::end;
+}
+
+int main() {
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  logConfig.maxGroupLength = cgMaxGroupLength;
+  Log::init(logConfig);
+  Log::registerCurrentTask("main");
+
+  dump("short:", cgShortDumpLength);
+  dump("long:", cgLongDumpLength);
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  std::string shortLine;
+  std::string longLine;
+  while(std::getline(in, line)) {
+    if(line.find("short:") != std::string::npos) {
+      shortLine = line;
+    }
+    else if(line.find("long:") != std::string::npos) {
+      longLine = line;
+    }
+    else { // nothing to do
+    }
+  }
+  std::cout << "short line: " << shortLine.size() << " characters, long line: " << longLine.size() << " characters, transmit buffer: " << cgTransmitBufferSize << std::endl;
+  bool const consistent = shortLine.size() > cgShortDumpLength * cgItemLength
+                       && shortLine.find("0x01f3 ") != std::string::npos
+                       && shortLine.find("Truncated") == std::string::npos
+                       && longLine.size() >= cgMaxGroupLength
+                       && longLine.size() < cgMaxGroupLength + cgItemLength + sizeof("-=- Truncated")
+                       && longLine.find("-=- Truncated") != std::string::npos;
+  std::cout << "consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderMmapFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <atomic>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadmmapfile.cpp -lpthread -o test-stdthreadmmapfile
+// Writes a small ring file while a deliberately slow MmapFileTailer follows it.
+// The writer overruns the tailer many times, and every line the tailer returns
+// must still be intact. At the end a new tailer must find the last line in the ring.
+
+constexpr size_t cgThreadCount = 4;
+constexpr int32_t cgLinesPerThread = 2000;
+constexpr uint64_t cgRingCapacity = 4096u;
+constexpr size_t cgReadChunkSize = 100u;
+char const cgRingFileName[] = "test-stdthreadmmapfile.ring";
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderMmapFile = nowtech::log::SenderMmapFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderMmapFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+std::atomic<bool> gWriting = true;
+size_t gIntactCount = 0u;
+size_t gBrokenCount = 0u;
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLinesPerThread; ++i) {
+    Log::i(nowtech::LogTopics::system) << "item:" << i << "of" << static_cast<uint16_t>(n) << "check:" << i * 7 + static_cast<int32_t>(n) << Log::end;
+    if(i % 50 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+/// Lines without an item are the registration notices.
+bool isIntact(std::string const &aLine) {
+  bool result = true;
+  char const *item = std::strstr(aLine.c_str(), "item:");
+  if(item != nullptr) {
+    int32_t index;
+    int32_t thread;
+    int32_t check;
+    result = std::sscanf(item, "item: %d of %d check: %d", &index, &thread, &check) == 3 && check == index * 7 + thread;
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+/// After a gap the first line is only a fragment, so it is not checked.
+void tail() {
+  nowtech::log::MmapFileTailer tailer;
+  uint64_t skipped = 0u;
+  if(tailer.open(cgRingFileName, true)) {
+    char buffer[cgReadChunkSize];
+    std::string line;
+    bool fragment = false;
+    bool writing = true;
+    uint64_t length = 0u;
+    while(writing || length > 0u) {
+      writing = gWriting;
+      length = tailer.read(buffer, cgReadChunkSize);
+      if(tailer.getSkippedCount() != skipped) {
+        skipped = tailer.getSkippedCount();
+        line.clear();
+        fragment = true;
+      }
+      else { // nothing to do
+      }
+      for(uint64_t i = 0u; i < length; ++i) {
+        if(buffer[i] == '\n') {
+          if(fragment) {
+            fragment = false;
+          }
+          else if(isIntact(line)) {
+            ++gIntactCount;
+          }
+          else {
+            std::printf("broken: %s\n", line.c_str());
+            ++gBrokenCount;
+          }
+          line.clear();
+        }
+        else {
+          line.push_back(buffer[i]);
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+  }
+  else { // nothing to do
+  }
+  std::printf("tailer: %zu intact lines, %zu broken, %llu bytes skipped\n", gIntactCount, gBrokenCount, static_cast<unsigned long long>(skipped));
+  if(skipped == 0u) {
+    ++gBrokenCount;   // The tailer should have been overrun.
+  }
+  else { // nothing to do
+  }
+}
+
+bool checkEnd() {
+  nowtech::log::MmapFileTailer tailer;
+  char buffer[cgRingCapacity + 1u];
+  uint64_t length = 0u;
+  if(tailer.open(cgRingFileName, true)) {
+    length = tailer.read(buffer, cgRingCapacity);
+  }
+  else { // nothing to do
+  }
+  buffer[length] = '\0';
+  char const *lastItem = std::strstr(buffer, "item: 1999 of ");
+  std::printf("ring holds %llu bytes, the last item %s\n", static_cast<unsigned long long>(length), lastItem == nullptr ? "is missing" : "is present");
+  return length == cgRingCapacity && lastItem != nullptr;
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  std::remove(cgRingFileName);
+  LogSenderMmapFile::init(cgRingFileName, cgRingCapacity);
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+  std::thread tailer(tail);
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  gWriting = false;
+  tailer.join();
+  bool const endPresent = checkEnd();
+  std::remove(cgRingFileName);
+  return gBrokenCount == 0u && gIntactCount > 0u && endPresent ? 0 : 1;
+}
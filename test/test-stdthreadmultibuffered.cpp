@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderMultiBuffered.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadmultibuffered.cpp -lpthread -o test-stdthreadmultibuffered
+// Writes through a pipe throttled to UART speed, and the main thread copies the pipe output to stdout.
+
+constexpr size_t cgThreadCount = 2;
+constexpr uint32_t cgBaudRate = 115200u;
+constexpr uint32_t cgBitsPerByte = 10u;   // 8N1
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgBufferSize = 1024u;
+constexpr uint32_t cgBufferCount = 2u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 444u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 20u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+
+/// Simulated slow blocking sink like a UART.
+class SenderThrottledPipe final {
+public:
+  using tAppInterface_   = LogAppInterfaceStd;
+  using tConverter_      = LogConverterCustomText;
+  using ConversionResult = char;
+  using Iterator         = char*;
+
+  static constexpr bool csVoid = false;
+
+private:
+  inline static int sFd;
+
+public:
+  static void init(int const aFd) noexcept {
+    sFd = aFd;
+  }
+
+  static void done() noexcept {
+    ::close(sFd);
+  }
+
+  static void send(char const * const aBegin, char const * const aEnd) {
+    size_t const length = aEnd - aBegin;
+    std::this_thread::sleep_for(std::chrono::microseconds(length * cgBitsPerByte * 1000000u / cgBaudRate));
+    if(::write(sFd, aBegin, length) != static_cast<ssize_t>(length)) {
+      LogAppInterfaceStd::error(nowtech::log::Exception::cSenderError);
+    }
+    else { // nothing to do
+    }
+  }
+
+  static void flush() noexcept { // nothing to do
+  }
+
+  static auto getBuffer() {
+    return std::pair(static_cast<Iterator>(nullptr), static_cast<Iterator>(nullptr));
+  }
+};
+
+using LogSender = nowtech::log::SenderMultiBuffered<SenderThrottledPipe, cgTransmitBufferSize, cgTimeout, cgBufferSize, cgBufferCount>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSender, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void periodicLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < 50; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "periodic item:" << i << Log::end;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  Log::unregisterCurrentTask();
+}
+
+void copyPipe(int const aFd) {
+  char buffer[256];
+  ssize_t count;
+  while((count = ::read(aFd, buffer, sizeof(buffer))) > 0) {
+    ::write(STDOUT_FILENO, buffer, count);
+  }
+}
+
+int main() {
+  int pipeFds[2];
+  if(::pipe(pipeFds) != 0) {
+    return 1;
+  }
+  else { // nothing to do
+  }
+  std::thread reader(copyPipe, pipeFds[0]);
+  std::thread threads[cgThreadCount];
+
+  LogSender::init(pipeFds[1]);
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  auto start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(periodicLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+  Log::i() << "producers took ms:" << static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()) << Log::end;
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  reader.join();
+  ::close(pipeFds[0]);
+  return 0;
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "LogStatisticsAtomic.h"
+#include "Log.h"
+
+#include <thread>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadpoolquota.cpp -lpthread -o test-stdthreadpoolquota
+
+constexpr size_t cgQuietThreadCount = 2;
+constexpr int32_t cgQuietLineCount = 500;
+constexpr int32_t cgNoisyItemCount = 250;
+constexpr int32_t cgNoisyPausePeriod = 20;
+
+char cgThreadNames[10][10] = {
+  "noisy",
+  "quiet_0",
+  "quiet_1",
+  "quiet_2",
+  "quiet_3",
+  "quiet_4",
+  "quiet_5",
+  "quiet_6",
+  "quiet_7",
+  "quiet_8"
+};
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgQuietThreadCount + 2;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 2048u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr bool cgStoreTopic = true;
+constexpr size_t cgQueueSize = 256u;         // The pool of partial groups has the same size.
+constexpr uint32_t cgTaskPoolQuota = 64u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadpoolquota.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint, cgStoreTopic>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using LogStatistics = nowtech::log::StatisticsAtomic<LogAppInterfaceStd, cgMaxTopicCount>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, LogStatistics>;
+
+std::atomic<bool> gQuietRunning;
+
+// Builds groups longer than its quota, slowly enough not to overflow the queue.
+void noisy() {
+  Log::registerCurrentTask(cgThreadNames[0]);
+  while(gQuietRunning) {
+    auto logger = Log::i() << "huge group:";
+    for(int32_t i = 0; i < cgNoisyItemCount; ++i) {
+      logger << i;
+      if(i % cgNoisyPausePeriod == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      else { // nothing to do
+      }
+    }
+    logger << Log::end;
+  }
+  Log::unregisterCurrentTask();
+}
+
+void quiet(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgQuietLineCount; ++i) {
+    Log::i() << "quiet item:" << i << Log::end;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  logConfig.taskPoolQuota = cgTaskPoolQuota;
+  Log::init(logConfig);
+
+  gQuietRunning = true;
+  std::thread noisyThread(noisy);
+  std::thread quietThreads[cgQuietThreadCount];
+  for(size_t i = 0; i < cgQuietThreadCount; ++i) {
+    quietThreads[i] = std::thread(quiet, i + 1u);
+  }
+  for(size_t i = 0; i < cgQuietThreadCount; ++i) {
+    quietThreads[i].join();
+  }
+  gQuietRunning = false;
+  noisyThread.join();
+
+  Log::done();
+
+  auto statistics = Log::getStatistics();
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  uint64_t quietCount = 0u;
+  uint64_t noisyCount = 0u;
+  while(std::getline(in, line)) {
+    if(line.find("quiet item:") != std::string::npos) {
+      ++quietCount;
+    }
+    else if(line.find("huge group:") != std::string::npos) {
+      ++noisyCount;
+    }
+    else { // nothing to do
+    }
+  }
+  std::cout << "quiet lines: " << quietCount << ", noisy lines: " << noisyCount << ", over quota: " << statistics.overQuotaCount
+            << ", pool exhausted: " << statistics.poolExhaustedCount << ", pool watermark: " << statistics.poolHighWatermark << std::endl;
+  bool const consistent = quietCount == cgQuietThreadCount * cgQuietLineCount
+                       && noisyCount == 0u
+                       && statistics.overQuotaCount > 0u
+                       && statistics.poolExhaustedCount == 0u
+                       && statistics.poolHighWatermark <= cgTaskPoolQuota + cgQuietThreadCount * 8u;
+  std::cout << "consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
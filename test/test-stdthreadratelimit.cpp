@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadratelimit.cpp -lpthread -o test-stdthreadratelimit
+
+constexpr size_t cgThreadCount = 2;
+constexpr int32_t cgIterationsPerThread = 200000;
+constexpr int32_t cgYieldPeriod = 1000;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance hot;
+  nowtech::log::TopicInstance sampled;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 16384u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadratelimit.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+constexpr typename LogAppInterfaceStd::LogTime cgLimitPeriod = 100u;
+constexpr uint32_t cgHotLimit = 10u;
+constexpr uint32_t cgSiteLimit = 5u;
+constexpr uint32_t cgSampleInterval = 100u;
+constexpr uint32_t cgSuppressionReportPeriod = 50u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void hotLoop(size_t n) {
+  static Log::RateLimit siteLimit{cgSiteLimit, cgLimitPeriod};
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgIterationsPerThread; ++i) {
+    Log::i(nowtech::LogTopics::hot) << "hot item:" << i << Log::end;
+    Log::i(nowtech::LogTopics::sampled) << "sampled item:" << i << Log::end;
+    Log::i(siteLimit) << "site item:" << i << Log::end;
+    if(i % cgYieldPeriod == 0) {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+struct Count final {
+  uint64_t admitted = 0u;
+  uint64_t suppressed = 0u;
+};
+
+struct Counts final {
+  Count hot;
+  Count sampled;
+  Count site;
+
+  uint64_t getSuppressed() const {
+    return hot.suppressed + sampled.suppressed + site.suppressed;
+  }
+};
+
+Counts readCounts() {
+  Counts result;
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  while(std::getline(in, line)) {
+    Count &count = (line.find(" hot ") != std::string::npos ? result.hot : (line.find(" sampled ") != std::string::npos ? result.sampled : result.site));
+    auto const position = line.find("-=- Suppressed ");
+    if(position != std::string::npos) {
+      count.suppressed += std::stoull(line.substr(position + 15u));
+    }
+    else {
+      ++count.admitted;
+    }
+  }
+  return result;
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  logConfig.suppressionReportPeriod = cgSuppressionReportPeriod;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::hot, "hot");
+  Log::registerTopic(nowtech::LogTopics::sampled, "sampled");
+  Log::setTopicRateLimit(nowtech::LogTopics::hot, cgHotLimit, cgLimitPeriod);
+  Log::setTopicSampling(nowtech::LogTopics::sampled, cgSampleInterval);
+
+  auto const start = std::chrono::steady_clock::now();
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(hotLoop, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+  auto const elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  // The idle transmitter reports the last suppressed counts, before done().
+  std::this_thread::sleep_for(std::chrono::milliseconds(cgSuppressionReportPeriod + 2u * cgRefreshPeriod));
+  uint64_t const idleSuppressed = readCounts().getSuppressed();
+  Log::done();
+
+  Counts const counts = readCounts();
+  Count const &hot = counts.hot;
+  Count const &sampled = counts.sampled;
+  Count const &site = counts.site;
+  uint64_t const attempts = cgThreadCount * cgIterationsPerThread;
+  auto const maxAdmitted = [elapsed](uint64_t const aLimit) { return aLimit + (elapsed * aLimit + cgLimitPeriod - 1u) / cgLimitPeriod; };   // Burst and refill.
+  std::cout << "elapsed: " << elapsed << " ms" << std::endl;
+  std::cout << "hot:     " << hot.admitted << " admitted, " << hot.suppressed << " suppressed" << std::endl;
+  std::cout << "sampled: " << sampled.admitted << " admitted, " << sampled.suppressed << " suppressed" << std::endl;
+  std::cout << "site:    " << site.admitted << " admitted, " << site.suppressed << " suppressed" << std::endl;
+  std::cout << "suppressed before done: " << idleSuppressed << std::endl;
+  bool const consistent = idleSuppressed == counts.getSuppressed()
+                       && hot.admitted + hot.suppressed == attempts
+                       && site.admitted + site.suppressed == attempts
+                       && sampled.admitted + sampled.suppressed == attempts
+                       && sampled.admitted >= attempts / cgSampleInterval && sampled.admitted <= attempts / cgSampleInterval + 1u
+                       && hot.admitted <= maxAdmitted(cgHotLimit)
+                       && site.admitted <= maxAdmitted(cgSiteLimit);
+  std::cout << "consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
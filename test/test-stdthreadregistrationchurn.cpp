@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderStdOstream.h"
+#include "LogQueueVoid.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+
+// clang++ -std=c++20 -O2 -Isrc -Icpp-memory-manager test/test-stdthreadregistrationchurn.cpp -lpthread -o test-stdthreadregistrationchurn
+// Benchmark for thread-per-request style code: spawns and joins thousands of
+// short-lived threads, each registering, logging a line and unregistering.
+
+constexpr size_t cgTotalThreadCount = 4000;
+constexpr size_t cgConcurrentThreadCount = 16;
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgConcurrentThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 10u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 444u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 43u;
+constexpr char cgLogFileName[] = "test-stdthreadregistrationchurn.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 123u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 444;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderStdOstream = nowtech::log::SenderStdOstream<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout>;
+using LogQueueVoid = nowtech::log::QueueVoid<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueVoid, LogSenderStdOstream, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+std::array<std::atomic<bool>, cgMaxTaskCount + 1u> gIdInUse;
+std::atomic<uint64_t> gRegisterNs = 0u;
+std::atomic<uint64_t> gUnregisterNs = 0u;
+std::atomic<size_t> gCollisionCount = 0u;
+
+uint64_t elapsedNs(std::chrono::steady_clock::time_point const aStart) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - aStart).count();
+}
+
+void shortLived(size_t n) {
+  auto start = std::chrono::steady_clock::now();
+  Log::registerCurrentTask("request");
+  gRegisterNs += elapsedNs(start);
+  auto id = Log::getCurrentTaskId();
+  if(gIdInUse[id].exchange(true)) {
+    ++gCollisionCount;
+  }
+  Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << Log::end;
+  gIdInUse[id] = false;
+  start = std::chrono::steady_clock::now();
+  Log::unregisterCurrentTask();
+  gUnregisterNs += elapsedNs(start);
+}
+
+int main() {
+  std::thread threads[cgConcurrentThreadCount];
+  std::ofstream out(cgLogFileName);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  LogSenderStdOstream::init(&out);
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  auto start = std::chrono::steady_clock::now();
+  for(size_t spawned = 0; spawned < cgTotalThreadCount; spawned += cgConcurrentThreadCount) {
+    for(size_t i = 0; i < cgConcurrentThreadCount; ++i) {
+      threads[i] = std::thread(shortLived, spawned + i);
+    }
+    for(size_t i = 0; i < cgConcurrentThreadCount; ++i) {
+      threads[i].join();
+    }
+  }
+  uint64_t const totalNs = elapsedNs(start);
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  out.close();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  size_t lineCount = 0u;
+  while(std::getline(in, line)) {
+    ++lineCount;
+  }
+  std::cout << "threads: " << cgTotalThreadCount << ", " << cgConcurrentThreadCount << " at a time" << std::endl;
+  std::cout << "total: " << totalNs / 1000000u << " ms, " << totalNs / cgTotalThreadCount << " ns per thread" << std::endl;
+  std::cout << "register: " << gRegisterNs / cgTotalThreadCount << " ns, unregister: " << gUnregisterNs / cgTotalThreadCount << " ns on average" << std::endl;
+  std::cout << "logged lines: " << lineCount << ", ID collisions: " << gCollisionCount << std::endl;
+  return lineCount == cgTotalThreadCount && gCollisionCount == 0u ? 0 : 1;
+}
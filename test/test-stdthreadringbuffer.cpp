@@ -0,0 +1,157 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderRingBuffer.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadringbuffer.cpp -lpthread -o test-stdthreadringbuffer
+// Logs several times the capacity of the ring in direct mode, dumping it once
+// meanwhile from an other thread and once at the end through a pipe. Each dump must hold consecutive items, and
+// the last one must be full and end with the last item.
+
+constexpr int32_t cgItemCount = 5000;
+constexpr size_t cgCapacity = 8u * 1024u;
+constexpr size_t cgDumpChunkSize = 1000u;
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = 2u;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 256u;   // Everything is in the ring when the logger returns.
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderRingBuffer = nowtech::log::SenderRingBuffer<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgCapacity, cgDumpChunkSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderRingBuffer, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+void burstLog() {
+  Log::registerCurrentTask("logger");
+  for(int32_t i = 0; i < cgItemCount; ++i) {
+    Log::i(nowtech::LogTopics::system) << "item:" << i << Log::end;
+    if(i % 500 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+/// The pipe must be read meanwhile, because the dump is larger than its buffer.
+std::string dump() {
+  std::string result;
+  int pipeFds[2];
+  if(::pipe(pipeFds) == 0) {
+    std::thread reader([&result, fd = pipeFds[0]]() {
+      char buffer[256];
+      ssize_t count;
+      while((count = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        result.append(buffer, count);
+      }
+    });
+    bool const success = LogSenderRingBuffer::dump(pipeFds[1]);
+    ::close(pipeFds[1]);
+    reader.join();
+    ::close(pipeFds[0]);
+    if(!success) {
+      result.clear();
+    }
+    else { // nothing to do
+    }
+  }
+  else { // nothing to do
+  }
+  return result;
+}
+
+/// The first line may be cut, the others must contain consecutive items.
+/// Returns the last item found, or -1 on error.
+int32_t checkConsecutive(std::string const &aDump) {
+  int32_t last = -1;
+  bool ok = true;
+  size_t begin = aDump.find('\n');
+  while(ok && begin != std::string::npos && begin + 1u < aDump.size()) {
+    size_t const end = aDump.find('\n', begin + 1u);
+    std::string const line = aDump.substr(begin + 1u, end == std::string::npos ? std::string::npos : end - begin - 1u);
+    char const *item = std::strstr(line.c_str(), "item:");
+    int32_t index;
+    if(item != nullptr && std::sscanf(item, "item: %d", &index) == 1) {
+      ok = last < 0 || index == last + 1;
+      last = index;
+    }
+    else { // nothing to do
+    }
+    begin = end;
+  }
+  return ok ? last : -1;
+}
+
+int main() {
+  LogSenderRingBuffer::init();
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  std::thread logger(burstLog);
+  std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  std::string const meanwhile = dump();
+  int32_t const lastMeanwhile = checkConsecutive(meanwhile);
+  logger.join();
+
+  std::string const atEnd = dump();
+  int32_t const lastAtEnd = checkConsecutive(atEnd);
+  Log::unregisterCurrentTask();
+  std::printf("meanwhile: %zu bytes up to item %d\n", meanwhile.size(), lastMeanwhile);
+  std::printf("at end: %zu bytes of %llu sent, up to item %d\n", atEnd.size(), static_cast<unsigned long long>(LogSenderRingBuffer::getTotalSize()), lastAtEnd);
+  bool const ok = lastMeanwhile >= 0 && atEnd.size() == cgCapacity && lastAtEnd == cgItemCount - 1;
+  Log::done();
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadstalegroup.cpp -lpthread -o test-stdthreadstalegroup
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = 2;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 1024u;
+constexpr uint32_t cgStaleGroupTimeout = 200u;
+constexpr uint32_t cgStaleCheckPeriod = 100u;
+// Much later than the flush, the late rest is still dropped.
+constexpr uint32_t cgStaleWait = 3u * cgStaleGroupTimeout + cgStaleCheckPeriod;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadstalegroup.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = cgStaleCheckPeriod;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+using LogHelper = decltype(Log::i());
+
+void earlyReturn(bool const aReturn) {
+  auto logger = Log::i() << "returned:";
+  logger << 1;
+  if(aReturn) {
+    return;
+  }
+  else { // nothing to do
+  }
+  logger << 2 << Log::end;
+}
+
+void thrown() {
+  try {
+    auto logger = Log::i() << "thrown:";
+    logger << 3;
+    throw std::runtime_error("abandoned");
+  }
+  catch(std::exception const &) { // nothing to do
+  }
+}
+
+int main() {
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  logConfig.staleGroupTimeout = cgStaleGroupTimeout;
+  Log::init(logConfig);
+  Log::registerCurrentTask("main");
+
+  earlyReturn(true);
+  thrown();
+  // Simulates a task getting stuck in the middle of a line, the terminal message arrives much later.
+  LogHelper *stuck = new LogHelper(Log::i() << "stale:" << 4);
+  std::this_thread::sleep_for(std::chrono::milliseconds(cgStaleWait));
+  delete stuck;
+  // A group of a single message in the same slot, right after the late rest.
+  Log::n() << "single" << Log::end;
+  Log::i() << "after:" << 5 << Log::end;
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  size_t lineCount = 0u;
+  bool returned = false;
+  bool wasThrown = false;
+  bool stale = false;
+  bool single = false;
+  bool after = false;
+  while(std::getline(in, line)) {
+    std::cout << line << std::endl;
+    ++lineCount;
+    returned = returned || (line.find("main") == 0u && line.find("returned: 1") != std::string::npos);
+    wasThrown = wasThrown || (line.find("main") == 0u && line.find("thrown: 3") != std::string::npos);
+    stale = stale || (line.find("-=- Stale group of task:") == 0u && line.find("stale: 4") != std::string::npos);
+    single = single || line.find("single") == 0u;
+    after = after || (line.find("main") == 0u && line.find("after: 5") != std::string::npos);
+  }
+  bool const consistent = returned && wasThrown && stale && single && after && lineCount == 5u;
+  std::cout << "consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderFile.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "LogStatisticsAtomic.h"
+#include "Log.h"
+
+#include <thread>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <filesystem>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadstatistics.cpp -lpthread -o test-stdthreadstatistics
+
+constexpr size_t cgThreadCount = 4;
+constexpr int32_t cgLinesPerThread = 2000;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2",
+  "thread_3"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+  nowtech::log::TopicInstance statistics;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgWriteBufferSize = 64u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr bool cgStoreTopic = true;
+constexpr size_t cgQueueSize = 16384u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 2;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgLogFileName[] = "test-stdthreadstatistics.log";
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+constexpr typename LogAppInterfaceStd::LogTime cgReportPeriod = 50u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint, cgStoreTopic>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderFile = nowtech::log::SenderFile<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgWriteBufferSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using LogStatistics = nowtech::log::StatisticsAtomic<LogAppInterfaceStd, cgMaxTopicCount>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderFile, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod, LogStatistics>;
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < cgLinesPerThread; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "burst item:" << i << Log::end;
+    if(i % 50 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main() {
+  std::thread threads[cgThreadCount];
+
+  nowtech::log::SenderFileConfig senderConfig;
+  senderConfig.fileName = cgLogFileName;
+  std::remove(cgLogFileName);
+  LogSenderFile::init(senderConfig);
+
+  nowtech::log::LogConfig logConfig;
+  logConfig.allowRegistrationLog = false;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerStatisticsTopic(nowtech::LogTopics::statistics, "stats", cgReportPeriod);
+  Log::registerCurrentTask("main");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+
+  auto statistics = Log::getStatistics();
+  std::cout << "pushed:          " << statistics.pushedCount << std::endl;
+  std::cout << "push failed:     " << statistics.pushFailedCount << std::endl;
+  std::cout << "popped:          " << statistics.poppedCount << std::endl;
+  std::cout << "sent:            " << statistics.sendCount << " times, " << statistics.bytesSent << " bytes" << std::endl;
+  std::cout << "discarded:       " << statistics.discardedGroupCount << std::endl;
+  std::cout << "sequence gaps:   " << statistics.sequenceGapCount << std::endl;
+  std::cout << "pool exhausted:  " << statistics.poolExhaustedCount << std::endl;
+  std::cout << "queue watermark: " << statistics.queueHighWatermark << std::endl;
+  std::cout << "pool watermark:  " << statistics.poolHighWatermark << std::endl;
+  auto printHistogram = [](char const * const aName, LogStatistics::Histogram const &aHistogram) {
+    uint64_t count = 0u;
+    for(auto const bucket : aHistogram) {
+      count += bucket;
+    }
+    std::cout << aName << " (us): " << count << " samples, p50 " << LogStatistics::getPercentile(aHistogram, 500u)
+              << ", p90 " << LogStatistics::getPercentile(aHistogram, 900u) << ", p99 " << LogStatistics::getPercentile(aHistogram, 990u)
+              << ", max " << LogStatistics::getPercentile(aHistogram, 1000u) << std::endl;
+    return count;
+  };
+  uint64_t const waitCount = printHistogram("queue wait", statistics.queueWaitHistogram);
+  uint64_t const convertCount = printHistogram("convert   ", statistics.convertHistogram);
+  uint64_t const sendCount = printHistogram("send      ", statistics.sendHistogram);
+  uint64_t const sampleCount = printHistogram("latency   ", statistics.latencyHistogram);
+  LogStatistics::Volume topicTotal;
+  for(size_t i = 0; i < LogStatistics::csTopicSlotCount; ++i) {
+    auto const &volume = statistics.topicVolumes[i];
+    std::cout << "topic " << i << ": " << volume.messageCount << " messages, " << volume.byteCount << " bytes, " << volume.droppedCount << " dropped" << std::endl;
+    topicTotal.messageCount += volume.messageCount;
+    topicTotal.byteCount += volume.byteCount;
+    topicTotal.droppedCount += volume.droppedCount;
+  }
+  LogStatistics::Volume taskTotal;
+  for(size_t i = 0; i < LogStatistics::csTaskSlotCount; ++i) {
+    auto const &volume = statistics.taskVolumes[i];
+    std::cout << "task " << i << ":  " << volume.messageCount << " messages, " << volume.byteCount << " bytes, " << volume.droppedCount << " dropped" << std::endl;
+    taskTotal.messageCount += volume.messageCount;
+    taskTotal.byteCount += volume.byteCount;
+    taskTotal.droppedCount += volume.droppedCount;
+  }
+
+  std::ifstream in(cgLogFileName);
+  std::string line;
+  size_t lineCount = 0u;
+  size_t reportLineCount = 0u;
+  size_t reportByteCount = 0u;
+  while(std::getline(in, line)) {
+    ++lineCount;
+    if(line.find(" stats ") != std::string::npos) {
+      ++reportLineCount;
+      reportByteCount += line.size() + 1u;
+    }
+    else { // nothing to do
+    }
+  }
+  bool const consistent = statistics.pushedCount == statistics.poppedCount
+                       && statistics.sendCount == lineCount
+                       && statistics.bytesSent == std::filesystem::file_size(cgLogFileName)
+                       && reportLineCount > 0u && reportLineCount % LogStatistics::csReportLineCount == 0u
+                       && convertCount == lineCount - reportLineCount && sendCount == convertCount
+                       && sampleCount > 0u && sampleCount == waitCount && sampleCount <= convertCount
+                       && topicTotal.messageCount == taskTotal.messageCount && topicTotal.byteCount == taskTotal.byteCount && topicTotal.droppedCount == taskTotal.droppedCount
+                       && topicTotal.byteCount + reportByteCount == statistics.bytesSent
+                       && statistics.topicVolumes[*nowtech::LogTopics::system].messageCount > 0u
+                       && statistics.topicVolumes[*nowtech::LogTopics::system].byteCount == LogStatistics::getTopicVolume(nowtech::LogTopics::system).byteCount;
+  std::cout << "lines: " << lineCount << ", report lines: " << reportLineCount << ", consistent: " << consistent << std::endl;
+  return consistent ? 0 : 1;
+}
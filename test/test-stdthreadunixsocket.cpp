@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogAppInterfaceStd.h"
+#include "LogConverterCustomText.h"
+#include "LogSenderUnixSocket.h"
+#include "LogQueueStdBoost.h"
+#include "LogMessageCompact.h"
+#include "Log.h"
+
+#include <poll.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <cstring>
+#include <iostream>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager test/test-stdthreadunixsocket.cpp -lpthread -o test-stdthreadunixsocket
+// Run it with the argument datagram to use datagram mode.
+
+constexpr size_t cgThreadCount = 3;
+
+char cgThreadNames[cgThreadCount][10] = {
+  "thread_0",
+  "thread_1",
+  "thread_2"
+};
+
+namespace nowtech::LogTopics {
+  nowtech::log::TopicInstance system;
+}
+
+constexpr nowtech::log::TaskId cgMaxTaskCount = cgThreadCount + 1;
+constexpr bool cgLogFromIsr = false;
+constexpr size_t cgTaskShutdownSleepPeriod = 100u;
+constexpr bool cgArchitecture64 = true;
+constexpr uint8_t cgAppendStackBufferSize = 100u;
+constexpr bool cgAppendBasePrefix = true;
+constexpr bool cgAlignSigned = false;
+constexpr size_t cgTransmitBufferSize = 123u;
+constexpr size_t cgFrameSize = 16u * 1024u;
+constexpr size_t cgBacklogSize = 256u * 1024u;
+constexpr size_t cgPayloadSize = 14u;
+constexpr bool cgSupportFloatingPoint = true;
+constexpr size_t cgQueueSize = 4096u;
+constexpr nowtech::log::LogTopic cgMaxTopicCount = 1;
+constexpr nowtech::log::TaskRepresentation cgTaskRepresentation = nowtech::log::TaskRepresentation::cName;
+constexpr size_t cgDirectBufferSize = 0u;
+constexpr char cgSocketPath[] = "test-stdthreadunixsocket.sock";
+constexpr int cgPollPeriod = 100;
+constexpr size_t cgReceiveBufferSize = 64u * 1024u;
+
+using LogAppInterfaceStd = nowtech::log::AppInterfaceStd<cgMaxTaskCount, cgLogFromIsr, cgTaskShutdownSleepPeriod>;
+constexpr typename LogAppInterfaceStd::LogTime cgTimeout = 200u;
+constexpr typename LogAppInterfaceStd::LogTime cgRefreshPeriod = 100u;
+constexpr typename LogAppInterfaceStd::LogTime cgReconnectPeriod = 50u;
+using LogMessage = nowtech::log::MessageCompact<cgPayloadSize, cgSupportFloatingPoint>;
+using LogConverterCustomText = nowtech::log::ConverterCustomText<LogMessage, cgArchitecture64, cgAppendStackBufferSize, cgAppendBasePrefix, cgAlignSigned>;
+using LogSenderUnixSocket = nowtech::log::SenderUnixSocket<LogAppInterfaceStd, LogConverterCustomText, cgTransmitBufferSize, cgTimeout, cgFrameSize, cgBacklogSize>;
+using LogQueueStdBoost = nowtech::log::QueueStdBoost<LogMessage, LogAppInterfaceStd, cgQueueSize>;
+using Log = nowtech::log::Log<LogQueueStdBoost, LogSenderUnixSocket, cgMaxTopicCount, cgTaskRepresentation, cgDirectBufferSize, cgRefreshPeriod>;
+
+std::atomic<bool> gListenerKeepAlive = true;
+
+// Stand-in for the collector: receives until the sender disconnects or the test ends, and counts the lines.
+void listener(int const aListenFd, bool const aDatagram) {
+  int fd = aListenFd;
+  if(!aDatagram) {
+    fd = ::accept(aListenFd, nullptr, nullptr);
+  }
+  else { // nothing to do
+  }
+  char buffer[cgReceiveBufferSize];
+  size_t lineCount = 0u;
+  size_t frameCount = 0u;
+  pollfd toPoll { fd, POLLIN, 0 };
+  while(gListenerKeepAlive) {
+    if(::poll(&toPoll, 1, cgPollPeriod) > 0) {
+      ssize_t received = ::recv(fd, buffer, sizeof(buffer), 0);
+      if(received > 0) {
+        lineCount += std::count(buffer, buffer + received, '\n');
+        ++frameCount;
+      }
+      else {
+        break;
+      }
+    }
+    else { // nothing to do
+    }
+  }
+  std::cout << "collector received lines: " << lineCount << " in frames: " << frameCount << std::endl;
+  if(fd != aListenFd) {
+    ::close(fd);
+  }
+  else { // nothing to do
+  }
+}
+
+void burstLog(size_t n) {
+  Log::registerCurrentTask(cgThreadNames[n]);
+  for(int32_t i = 0; i < 1000; ++i) {
+    Log::i(nowtech::LogTopics::system) << static_cast<uint16_t>(n) << "burst item:" << i << Log::end;
+    if(i % 10 == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    else { // nothing to do
+    }
+  }
+  Log::unregisterCurrentTask();
+}
+
+int main(int argc, char **argv) {
+  std::thread threads[cgThreadCount];
+  bool const datagram = (argc > 1 && std::strcmp(argv[1], "datagram") == 0);
+
+  ::unlink(cgSocketPath);
+  LogSenderUnixSocket::init(cgSocketPath, datagram ? nowtech::log::UnixSocketMode::cDatagram : nowtech::log::UnixSocketMode::cStream, cgReconnectPeriod);
+
+  nowtech::log::LogConfig logConfig;
+  Log::init(logConfig);
+  Log::registerTopic(nowtech::LogTopics::system, "system");
+  Log::registerCurrentTask("main");
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i] = std::thread(burstLog, i);
+  }
+
+  // The collector starts late, so the early output must wait in the backlog.
+  std::this_thread::sleep_for(std::chrono::milliseconds(300));
+  int listenFd = ::socket(AF_UNIX, datagram ? SOCK_DGRAM : SOCK_STREAM, 0);
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, cgSocketPath);
+  ::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+  if(!datagram) {
+    ::listen(listenFd, 1);
+  }
+  else { // nothing to do
+  }
+  std::thread collector(listener, listenFd, datagram);
+
+  for(size_t i = 0; i < cgThreadCount; ++i) {
+    threads[i].join();
+  }
+
+  Log::unregisterCurrentTask();
+  Log::done();
+  std::this_thread::sleep_for(std::chrono::milliseconds(cgPollPeriod * 2));
+  gListenerKeepAlive = false;
+  collector.join();
+  std::cout << "dropped frames: " << LogSenderUnixSocket::getDroppedCount() << std::endl;
+  ::close(listenFd);
+  ::unlink(cgSocketPath);
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018 Now Technologies Zrt.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+ * CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH
+ * THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include "LogSenderMmapFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <chrono>
+
+// clang++ -std=c++20 -Isrc -Icpp-memory-manager tools/logtail.cpp -o logtail
+// Usage: logtail [-f] ringfile
+// Without -f, dumps the content still present in the ring written by SenderMmapFile.
+// With -f, dumps it and keeps following the new content like tail -f.
+// If the writer overruns it, the lost part is marked and following continues.
+
+constexpr size_t cgBufferSize = 64u * 1024u;
+constexpr auto cgPollPeriod = std::chrono::milliseconds(50);
+
+char gBuffer[cgBufferSize];
+
+int main(int aArgc, char **aArgv) {
+  bool follow = aArgc == 3 && std::strcmp(aArgv[1], "-f") == 0;
+  if(aArgc != 2 && !follow) {
+    std::fprintf(stderr, "Usage: %s [-f] ringfile\n", aArgv[0]);
+    return 1;
+  }
+  else { // nothing to do
+  }
+  nowtech::log::MmapFileTailer tailer;
+  if(!tailer.open(aArgv[aArgc - 1], true)) {
+    std::fprintf(stderr, "Cannot open ring file %s\n", aArgv[aArgc - 1]);
+    return 2;
+  }
+  else { // nothing to do
+  }
+  uint64_t skipped = 0u;
+  do {
+    uint64_t length;
+    while((length = tailer.read(gBuffer, cgBufferSize)) > 0u) {
+      if(tailer.getSkippedCount() != skipped) {
+        std::printf("\n-=- logtail skipped %llu bytes overwritten by the writer\n", static_cast<unsigned long long>(tailer.getSkippedCount() - skipped));
+        skipped = tailer.getSkippedCount();
+      }
+      else { // nothing to do
+      }
+      std::fwrite(gBuffer, 1u, length, stdout);
+    }
+    std::fflush(stdout);
+    if(follow) {
+      std::this_thread::sleep_for(cgPollPeriod);
+    }
+    else { // nothing to do
+    }
+  } while(follow);
+  return 0;
+}